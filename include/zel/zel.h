@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +14,11 @@ extern "C" {
 #define ZEL_FRAME_INDEX_ENTRY_DISK_SIZE 11
 #define ZEL_FRAME_HEADER_DISK_SIZE 14
 
+#define ZEL_INDEX_NONE 0xFFFFFFFFu
+
+/* zelInitFdStream / zelOpenFile flag: bypass the page cache (O_DIRECT, or F_NOCACHE on macOS). */
+#define ZEL_FILE_DIRECT 0x1u
+
 /* Enums */
 
 typedef enum { ZEL_COLOR_FORMAT_INDEXED8 = 0 } ZELColorFormat;
@@ -23,10 +29,58 @@ typedef enum {
     ZEL_COMPRESSION_RLE = 2
 } ZELCompressionType;
 
-typedef enum { ZEL_COLOR_RGB565_LE = 0, ZEL_COLOR_RGB565_BE = 1 } ZELColorEncoding;
+/* ARGB4444 is a palette encoding only; RGB565 output from such palettes is little-endian
+   unless another output encoding is set, and alpha is used by zelDecodeFrameRgb565Blend. */
+typedef enum {
+    ZEL_COLOR_RGB565_LE = 0,
+    ZEL_COLOR_RGB565_BE = 1,
+    ZEL_COLOR_ARGB4444_LE = 2
+} ZELColorEncoding;
 
 typedef enum { ZEL_PALETTE_TYPE_GLOBAL = 0, ZEL_PALETTE_TYPE_LOCAL = 1 } ZELPaletteType;
 
+/* How stream contexts fetch frame data: the whole frame at once, or one zone chunk at a time
+   into the zone buffer (LZ4 chunks are then decompressed in place). */
+typedef enum { ZEL_STREAM_READ_FRAME = 0, ZEL_STREAM_READ_ZONE = 1 } ZELStreamReadMode;
+
+typedef enum {
+    ZEL_PRELOAD_NEVER = 0,
+    ZEL_PRELOAD_ALWAYS = 1,
+    ZEL_PRELOAD_BELOW_SIZE = 2
+} ZELPreloadMode;
+
+/* Packed panel formats. 444 packs two pixels into three bytes (R0G0 B0R1 G1B1); 666 keeps
+   each 6-bit channel in the top bits of its byte; BGR variants swap red and blue. */
+typedef enum {
+    ZEL_PACKED_RGB444 = 0,
+    ZEL_PACKED_BGR444 = 1,
+    ZEL_PACKED_RGB666 = 2,
+    ZEL_PACKED_BGR666 = 3,
+    ZEL_PACKED_RGB888 = 4,
+    ZEL_PACKED_BGR888 = 5
+} ZELPackedFormat;
+
+/* Monochrome and grayscale targets. MONO1_ROWS packs 8 pixels per byte, MSB first.
+   MONO1_PAGES is the SSD1306 layout: each byte holds 8 vertical pixels, LSB on top, and a
+   page of 8 rows spans dstStrideBytes. GRAY4_ROWS packs 2 pixels per byte, high nibble first. */
+typedef enum {
+    ZEL_GRAY_MONO1_ROWS = 0,
+    ZEL_GRAY_MONO1_PAGES = 1,
+    ZEL_GRAY_GRAY4_ROWS = 2
+} ZELGrayFormat;
+
+/* Output orientation flags. The transpose is applied first, then the flips in output space.
+   Rotations are clockwise; transposing orientations produce a height x width image. */
+typedef enum {
+    ZEL_ORIENTATION_IDENTITY = 0,
+    ZEL_ORIENTATION_FLIP_X = 1,
+    ZEL_ORIENTATION_FLIP_Y = 2,
+    ZEL_ORIENTATION_TRANSPOSE = 4,
+    ZEL_ORIENTATION_ROTATE_90 = ZEL_ORIENTATION_TRANSPOSE | ZEL_ORIENTATION_FLIP_X,
+    ZEL_ORIENTATION_ROTATE_180 = ZEL_ORIENTATION_FLIP_X | ZEL_ORIENTATION_FLIP_Y,
+    ZEL_ORIENTATION_ROTATE_270 = ZEL_ORIENTATION_TRANSPOSE | ZEL_ORIENTATION_FLIP_Y
+} ZELOrientation;
+
 typedef enum {
     ZEL_OK = 0,
     ZEL_ERR_INVALID_ARGUMENT,
@@ -97,10 +151,75 @@ typedef struct {
     uint8_t reserved[3];
 } ZELPaletteHeader;
 
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} ZELRect;
+
+/* One contiguous copy; see zelBuildFrameIndex8Copies. */
+typedef struct {
+    const void *src;
+    void *dst;
+    size_t length;
+} ZELCopyDescriptor;
+
 typedef struct ZELContext ZELContext;
+typedef struct ZELFrameDecoder ZELFrameDecoder;
+typedef struct ZELPlayer ZELPlayer;
+typedef struct ZELCompositor ZELCompositor;
+
+/* One animation frame placed on a compositor screen. Higher z draws on top; equal z keeps the
+   order of the layer array. Pixels holding transparentIndex are see-through; -1 makes the
+   layer opaque, which lets the compositor skip everything it fully covers. */
+typedef struct {
+    const ZELContext *ctx;
+    uint32_t frameIndex;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    int16_t transparentIndex;
+} ZELLayer;
+
+/* Result of zelPlayerUpdate. Times use the caller's millisecond clock. */
+typedef struct {
+    uint32_t frameIndex;     /* frame to display now */
+    int frameChanged;        /* nonzero when frameIndex differs from the one last returned */
+    uint32_t nextDeadlineMs; /* when the displayed frame is due to change */
+    uint32_t framesDropped;  /* frames skipped since the previous update */
+} ZELPlayerTick;
+
+/* Monotonic clock in microseconds; wraparound is handled. */
+typedef uint32_t (*ZELClockFunc)(void *userData);
+
+typedef void (*ZELPaletteTransformFunc)(void *userData,
+                                        uint16_t *entries,
+                                        uint16_t count,
+                                        ZELColorEncoding encoding);
+
+typedef struct {
+    uint16_t brightness;     /* 256 = unchanged */
+    uint16_t tintRed;        /* 256 = unchanged */
+    uint16_t tintGreen;      /* 256 = unchanged */
+    uint16_t tintBlue;       /* 256 = unchanged */
+    const uint8_t *gammaLut; /* optional 256-entry curve applied to 8-bit channel values */
+} ZELPaletteAdjust;
 
 typedef size_t (*ZELStreamReadFunc)(void *userData, size_t offset, void *dst, size_t size);
 typedef void (*ZELStreamCloseFunc)(void *userData);
+/* Announces a byte range the decoder expects to read soon. It is advisory: the range is still
+   read through read(), and the hint may be ignored. */
+typedef void (*ZELStreamHintFunc)(void *userData, size_t offset, size_t size);
+
+typedef struct {
+    size_t offset;
+    void *dst;
+    size_t size;
+} ZELStreamRange;
+
+/* Fills every range completely, in any order; returns count on success. */
+typedef size_t (*ZELStreamReadvFunc)(void *userData, const ZELStreamRange *ranges, size_t count);
 
 typedef struct {
     ZELStreamReadFunc read;
@@ -109,9 +228,112 @@ typedef struct {
     size_t size;
 } ZELInputStream;
 
+typedef void (*ZELTaskFunc)(void *taskData, uint32_t taskIndex, uint32_t workerIndex);
+typedef void (*ZELWorkerPoolRunFunc)(void *userData,
+                                     ZELTaskFunc task,
+                                     void *taskData,
+                                     uint32_t taskCount);
+
+typedef struct {
+    ZELWorkerPoolRunFunc run;
+    void *userData;
+    uint32_t workerCount;
+} ZELWorkerPool;
+
+typedef struct {
+    const ZELContext *ctx;
+    uint32_t frameIndex;
+    uint16_t *dst;
+    size_t dstStridePixels;
+    ZELResult result;
+} ZELDecodeJob;
+
+typedef struct ZELScheduler ZELScheduler;
+
+/* A frame due by deadlineUs on the scheduler clock. finishUs, missedDeadline and result are
+   filled in by zelSchedulerRun. */
+typedef struct {
+    const ZELContext *ctx;
+    uint32_t frameIndex;
+    uint16_t *dst;
+    size_t dstStridePixels;
+    uint32_t deadlineUs;
+    uint32_t finishUs;
+    int missedDeadline;
+    ZELResult result;
+} ZELScheduledJob;
+
+typedef struct {
+    uint32_t jobCount;
+    uint32_t taskCount;
+    uint32_t missedDeadlines;
+    uint32_t worstLatenessUs;
+} ZELScheduleReport;
+
+typedef struct {
+    ZELResult result;
+    uint32_t frameIndex; /* ZEL_INDEX_NONE when the failure is not tied to a frame */
+    uint32_t zoneIndex;  /* ZEL_INDEX_NONE when the failure is not tied to a zone */
+} ZELValidationReport;
+
+/* Receives one finished zone. The pixels stay valid until the next call for the same frame
+   returns, so a transfer started here may run while the following zone is decoded. */
+typedef ZELResult (*ZELZoneSinkFunc)(void *userData,
+                                     uint16_t x,
+                                     uint16_t y,
+                                     uint16_t width,
+                                     uint16_t height,
+                                     const uint16_t *pixels);
+
+typedef ZELResult (*ZELFrameSinkFunc)(void *userData,
+                                     uint32_t frameIndex,
+                                     const uint16_t *pixels,
+                                     size_t stridePixels,
+                                     uint32_t workerIndex);
+
 ZELContext *zelOpenMemory(const uint8_t *data, size_t size, ZELResult *outResult);
 ZELContext *zelOpenStream(const ZELInputStream *stream, ZELResult *outResult);
 
+/* Copies a stream into RAM with large sequential reads, after which the context decodes through
+   the zero-copy memory path. ZEL_PRELOAD_BELOW_SIZE preloads only streams of at most maxBytes,
+   and streams on when the buffer cannot be allocated; ZEL_PRELOAD_ALWAYS fails with
+   ZEL_ERR_OUT_OF_MEMORY instead. With deferred set, the call returns once the headers are read
+   and zelPreloadStep copies the rest; until then decodes read the stream, or the part already
+   copied. zelPreloadStep must not run concurrently with decodes on the same context. */
+typedef struct {
+    ZELPreloadMode mode;
+    size_t maxBytes;   /* ZEL_PRELOAD_BELOW_SIZE limit */
+    size_t chunkBytes; /* bytes per read; 0 selects 64 KiB */
+    int deferred;
+} ZELPreloadOptions;
+
+ZELContext *zelOpenStreamPreload(const ZELInputStream *stream,
+                                 const ZELPreloadOptions *options,
+                                 ZELResult *outResult);
+/* Reads the next chunk of a deferred preload. *outRemaining is 0 once the context decodes from
+   RAM, and also for contexts with nothing to preload. */
+ZELResult zelPreloadStep(ZELContext *ctx, size_t *outRemaining);
+
+/* Built-in POSIX stream sources; on other platforms they return ZEL_ERR_UNSUPPORTED_FORMAT.
+   zelInitStdioStream reads under the FILE lock, and zelInitFdStream reads with pread, so both
+   may be shared between workers. With ZEL_FILE_DIRECT, fd must have been opened with
+   O_DIRECT; reads then go through block-aligned bounce buffers. Neither stream closes its
+   handle. zelOpenFile opens path itself and closes it in zelClose; without ZEL_FILE_DIRECT it
+   also installs a read-ahead hint that forwards to POSIX_FADV_WILLNEED where available. */
+ZELResult zelInitStdioStream(FILE *file, ZELInputStream *outStream);
+ZELResult zelInitFdStream(int fd, uint32_t flags, ZELInputStream *outStream);
+ZELContext *zelOpenFile(const char *path, uint32_t flags, ZELResult *outResult);
+
+/* Keeps up to queueDepth (1..64) whole frame blocks read ahead of the decode position with
+   io_uring, wrapping at the loop point. fd is the file behind the stream context, or -1 to
+   reuse the descriptor of a zelInitFdStream or zelOpenFile stream; it must stay open until
+   zelClose. Blocks are decoded in place from the queue buffers. Only full-frame decodes that
+   use the context's own scratch go through the queue; zone-read mode and worker pools keep
+   reading the stream. queueDepth 0 turns prefetching off. Requires Linux and a build with
+   ZEL_ENABLE_IO_URING (make IO_URING=1); otherwise returns ZEL_ERR_UNSUPPORTED_FORMAT, as it
+   does when the kernel refuses io_uring. */
+ZELResult zelEnableUringPrefetch(ZELContext *ctx, int fd, uint32_t queueDepth);
+
 void zelClose(ZELContext *ctx);
 
 uint16_t zelGetWidth(const ZELContext *ctx);
@@ -125,6 +347,23 @@ ZELColorFormat zelGetColorFormat(const ZELContext *ctx);
 void zelSetOutputColorEncoding(ZELContext *ctx, ZELColorEncoding encoding);
 ZELColorEncoding zelGetOutputColorEncoding(const ZELContext *ctx);
 
+void zelSetPaletteTransform(ZELContext *ctx, ZELPaletteTransformFunc transform, void *userData);
+ZELResult zelSetPaletteAdjust(ZELContext *ctx, const ZELPaletteAdjust *adjust);
+
+ZELResult zelSetTrustedMode(ZELContext *ctx, int enabled);
+int zelIsTrustedMode(const ZELContext *ctx);
+ZELResult zelSetStreamReadMode(ZELContext *ctx, ZELStreamReadMode mode);
+/* Optional read-ahead hint for a stream context, called with the stream's userData: with the
+   next frame block once frames are decoded in sequence, and with the wanted zone chunks before
+   a clipped decode in zone-read mode. Like read, it may be called from worker threads. NULL
+   turns hints off. */
+ZELResult zelSetStreamHint(ZELContext *ctx, ZELStreamHintFunc hint);
+/* Optional vectored read for a stream context, called with the stream's userData. In zone-read
+   mode a clipped decode then fetches all its wanted zone chunks with one call, one range per run
+   of adjacent chunks, instead of one read per chunk. The ranges land in a buffer as large as
+   those runs together. NULL goes back to read. */
+ZELResult zelSetStreamReadv(ZELContext *ctx, ZELStreamReadvFunc readv);
+
 int zelHasGlobalPalette(const ZELContext *ctx);
 
 ZELResult zelGetGlobalPalette(const ZELContext *ctx,
@@ -156,6 +395,20 @@ ZELResult zelDecodeFrameIndex8Zone(const ZELContext *ctx,
                                    uint32_t zoneIndex,
                                    uint8_t *dst);
 
+/* Describes an index8 decode of a raw (ZEL_COMPRESSION_NONE) frame in a memory context as
+   copies from the file into dst, for a DMA engine to execute. region NULL means the whole
+   frame; dst is always addressed in frame coordinates. When descriptorCapacity is too small
+   the call returns ZEL_ERR_OUT_OF_BOUNDS and *outCount holds the number needed. */
+ZELResult zelBuildFrameIndex8Copies(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    const ZELRect *region,
+                                    uint8_t *dst,
+                                    size_t dstStrideBytes,
+                                    ZELCopyDescriptor *descriptors,
+                                    size_t descriptorCapacity,
+                                    size_t *outCount);
+void zelExecuteCopies(const ZELCopyDescriptor *descriptors, size_t count);
+
 ZELResult zelDecodeFrameRgb565(const ZELContext *ctx,
                                uint32_t frameIndex,
                                uint16_t *dst,
@@ -166,6 +419,135 @@ ZELResult zelDecodeFrameRgb565Zone(const ZELContext *ctx,
                                    uint32_t zoneIndex,
                                    uint16_t *dst);
 
+/* Alpha-blends the frame onto the existing contents of dst (in the output encoding) using the
+   palette's alpha; RGB565 palettes are fully opaque. */
+ZELResult zelDecodeFrameRgb565Blend(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels);
+
+/* dstStrideBytes must hold a packed row: width * 3 bytes, or (width * 3 + 1) / 2 for 444. */
+ZELResult zelDecodeFramePacked(const ZELContext *ctx,
+                               uint32_t frameIndex,
+                               ZELPackedFormat format,
+                               uint8_t *dst,
+                               size_t dstStrideBytes);
+
+/* dither enables a 4x4 ordered dither; otherwise each pixel rounds to the nearest level. */
+ZELResult zelDecodeFrameGray(const ZELContext *ctx,
+                             uint32_t frameIndex,
+                             ZELGrayFormat format,
+                             int dither,
+                             uint8_t *dst,
+                             size_t dstStrideBytes);
+
+/* Decodes through a caller-built table of lutCount entries, each elementSize (1-4) bytes and
+   indexed by palette index, so any panel format can be produced by copying entries. The frame
+   palette is not used; convert it with zelGetFramePalette when building the table. */
+ZELResult zelDecodeFrameLut(const ZELContext *ctx,
+                            uint32_t frameIndex,
+                            const void *lut,
+                            uint16_t lutCount,
+                            uint32_t elementSize,
+                            void *dst,
+                            size_t dstPitchBytes);
+
+ZELResult zelDecodeFrameRgb565Oriented(const ZELContext *ctx,
+                                       uint32_t frameIndex,
+                                       ZELOrientation orientation,
+                                       uint16_t *dst,
+                                       size_t dstStridePixels);
+
+/* Decodes with the frame's top-left corner at (originX, originY) on a larger canvas. Only pixels
+   inside clip (canvas coordinates) are written; zones entirely outside it are not decompressed.
+   The origin may be negative or place the frame partly outside the clip. */
+ZELResult zelDecodeFrameRgb565At(const ZELContext *ctx,
+                                 uint32_t frameIndex,
+                                 int32_t originX,
+                                 int32_t originY,
+                                 const ZELRect *clip,
+                                 uint16_t *canvas,
+                                 size_t canvasStridePixels);
+
+/* zoneBuffers holds 2 * zoneWidth * zoneHeight pixels, or NULL to use context scratch. */
+ZELResult zelDecodeFrameRgb565ToZones(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      uint16_t *zoneBuffers,
+                                      ZELZoneSinkFunc sink,
+                                      void *userData);
+
+ZELFrameDecoder *zelCreateFrameDecoder(const ZELContext *ctx, ZELResult *outResult);
+void zelDestroyFrameDecoder(ZELFrameDecoder *decoder);
+ZELResult zelFrameDecoderBegin(ZELFrameDecoder *decoder,
+                               uint32_t frameIndex,
+                               uint16_t *dst,
+                               size_t dstStridePixels);
+ZELResult zelFrameDecoderStep(ZELFrameDecoder *decoder, uint32_t maxZones, int *outDone);
+ZELResult zelFrameDecoderStepTimed(ZELFrameDecoder *decoder,
+                                   uint32_t budgetUs,
+                                   ZELClockFunc clock,
+                                   void *clockUserData,
+                                   int *outDone);
+
+ZELResult zelRenderIndex8Rgb565(const uint8_t *src,
+                                size_t srcStrideBytes,
+                                uint16_t width,
+                                uint16_t height,
+                                const uint16_t *palette,
+                                uint16_t paletteCount,
+                                uint16_t *dst,
+                                size_t dstStridePixels);
+
+ZELResult zelRenderIndex8Argb8888(const uint8_t *src,
+                                  size_t srcStrideBytes,
+                                  uint16_t width,
+                                  uint16_t height,
+                                  const uint32_t *palette,
+                                  uint16_t paletteCount,
+                                  uint32_t *dst,
+                                  size_t dstStridePixels);
+
+ZELResult zelConvertPaletteToArgb8888(const uint16_t *src,
+                                      uint16_t count,
+                                      ZELColorEncoding encoding,
+                                      uint32_t *dst);
+
+ZELResult zelDecodeBatchRgb565(ZELDecodeJob *jobs, size_t jobCount, const ZELWorkerPool *pool);
+
+ZELResult zelDecodeFrameRangeRgb565(const ZELContext *ctx,
+                                    uint32_t firstFrame,
+                                    uint32_t frameCount,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels,
+                                    size_t dstFramePitchPixels,
+                                    const ZELWorkerPool *pool);
+
+ZELResult zelDecodeFrameRangeRgb565ToSink(const ZELContext *ctx,
+                                          uint32_t firstFrame,
+                                          uint32_t frameCount,
+                                          ZELFrameSinkFunc sink,
+                                          void *sinkUserData,
+                                          const ZELWorkerPool *pool);
+
+/* Decodes a set of due frames over the pool in deadline order. Each frame of a memory context
+   is split into up to workerCount bands of zones, and tasks are numbered earliest deadline
+   first, so a pool that starts tasks in index order works on the most urgent frame first.
+   Per-worker scratch is owned by the scheduler and reused across runs. clock (microseconds)
+   is read once at the start and again as each task finishes, possibly from several workers.
+   Returns the first failing job's result in job order. */
+ZELScheduler *zelCreateScheduler(const ZELWorkerPool *pool, ZELResult *outResult);
+void zelDestroyScheduler(ZELScheduler *scheduler);
+ZELResult zelSchedulerRun(ZELScheduler *scheduler,
+                          ZELScheduledJob *jobs,
+                          uint32_t jobCount,
+                          ZELClockFunc clock,
+                          void *clockUserData,
+                          ZELScheduleReport *outReport);
+
+ZELResult zelValidate(const ZELContext *ctx,
+                      const ZELWorkerPool *pool,
+                      ZELValidationReport *outReport);
+
 ZELResult zelGetTotalDurationMs(const ZELContext *ctx, uint32_t *outTotalDurationMs);
 
 ZELResult zelFindFrameByTimeMs(const ZELContext *ctx,
@@ -173,6 +555,35 @@ ZELResult zelFindFrameByTimeMs(const ZELContext *ctx,
                                uint32_t *outFrameIndex,
                                uint32_t *outFrameStartMs);
 
+/* Composites layers over a background colour straight into dst. The screen is split into
+   tileSize squares, and only tiles under a layer whose fields changed since the previous call
+   are redrawn, so dst must still hold the previous result. A different dst, stride or
+   background redraws everything, and so does zelCompositorInvalidate (use it after changing a
+   palette transform). outTilesDrawn, when not NULL, receives the number of tiles redrawn. */
+ZELCompositor *zelCreateCompositor(uint16_t width,
+                                   uint16_t height,
+                                   uint16_t tileSize,
+                                   ZELResult *outResult);
+void zelDestroyCompositor(ZELCompositor *compositor);
+void zelCompositorInvalidate(ZELCompositor *compositor);
+ZELResult zelComposite(ZELCompositor *compositor,
+                       const ZELLayer *layers,
+                       uint32_t layerCount,
+                       uint16_t background,
+                       uint16_t *dst,
+                       size_t dstStridePixels,
+                       uint32_t *outTilesDrawn);
+
+/* Looping playback driven by the caller's clock. Each update maps the time since startMs onto the
+   timeline with a binary search over cumulative frame times. Decode only when frameChanged is
+   set, then sleep until nextDeadlineMs. When updates arrive late the player skips to the frame
+   that is due instead of falling behind, and counts the skipped frames as dropped. */
+ZELPlayer *zelCreatePlayer(const ZELContext *ctx, uint32_t startMs, ZELResult *outResult);
+void zelDestroyPlayer(ZELPlayer *player);
+void zelPlayerReset(ZELPlayer *player, uint32_t nowMs);
+ZELResult zelPlayerUpdate(ZELPlayer *player, uint32_t nowMs, ZELPlayerTick *outTick);
+uint32_t zelPlayerGetDroppedFrames(const ZELPlayer *player);
+
 const char *zelResultToString(ZELResult result);
 
 #ifdef __cplusplus
@@ -0,0 +1,586 @@
+#include "zel_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    ZELDecodeJob *jobs;
+    ZELScratch *scratch;
+    uint32_t scratchCount;
+} ZELBatchTaskData;
+
+static ZELResult zelCheckDecodeTarget(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      const uint16_t *dst,
+                                      size_t dstStridePixels) {
+    if (!ctx || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (frameIndex >= ctx->header.frameCount)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (dstStridePixels < ctx->header.width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    return ZEL_OK;
+}
+
+static ZELResult zelCheckDecodeJob(const ZELDecodeJob *job) {
+    return zelCheckDecodeTarget(job->ctx, job->frameIndex, job->dst, job->dstStridePixels);
+}
+
+/* Global palette conversion is cached on the context; callers resolve it before starting
+   workers so that they only ever read it. */
+static ZELResult zelPrepareSharedPalette(const ZELContext *ctx) {
+    if (!ctx->globalPaletteRaw)
+        return ZEL_OK;
+
+    const uint16_t *entries = NULL;
+    uint16_t count = 0;
+    return zelResolveGlobalPalette(ctx, &entries, &count);
+}
+
+static void zelRunBatchJob(void *taskData, uint32_t taskIndex, uint32_t workerIndex) {
+    ZELBatchTaskData *batch = (ZELBatchTaskData *)taskData;
+    ZELDecodeJob *job = &batch->jobs[taskIndex];
+
+    if (job->result != ZEL_OK)
+        return;
+
+    if (workerIndex >= batch->scratchCount) {
+        job->result = ZEL_ERR_INTERNAL;
+        return;
+    }
+
+    job->result = zelDecodeFrameRgb565WithScratch(job->ctx,
+                                                  job->frameIndex,
+                                                  &batch->scratch[workerIndex],
+                                                  job->dst,
+                                                  job->dstStridePixels);
+}
+
+ZELResult zelDecodeBatchRgb565(ZELDecodeJob *jobs, size_t jobCount, const ZELWorkerPool *pool) {
+    if (!jobs && jobCount > 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (jobCount == 0)
+        return ZEL_OK;
+
+    if (jobCount > UINT32_MAX)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    int parallel = (pool && pool->run && pool->workerCount > 0);
+    uint32_t scratchCount = parallel ? pool->workerCount : 1;
+
+    /* Allocated first so that a failure is reported in every job result, not just returned. */
+    ZELScratch *scratch = (ZELScratch *)calloc(scratchCount, sizeof(ZELScratch));
+    if (!scratch) {
+        for (size_t i = 0; i < jobCount; ++i)
+            jobs[i].result = ZEL_ERR_OUT_OF_MEMORY;
+        return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    const ZELContext *preparedCtx = NULL;
+    for (size_t i = 0; i < jobCount; ++i) {
+        ZELDecodeJob *job = &jobs[i];
+        job->result = zelCheckDecodeJob(job);
+        if (job->result != ZEL_OK || job->ctx == preparedCtx)
+            continue;
+
+        job->result = zelPrepareSharedPalette(job->ctx);
+        preparedCtx = job->ctx;
+    }
+
+    ZELBatchTaskData batch;
+    batch.jobs = jobs;
+    batch.scratch = scratch;
+    batch.scratchCount = scratchCount;
+
+    if (parallel) {
+        pool->run(pool->userData, zelRunBatchJob, &batch, (uint32_t)jobCount);
+    } else {
+        for (uint32_t i = 0; i < (uint32_t)jobCount; ++i)
+            zelRunBatchJob(&batch, i, 0);
+    }
+
+    for (uint32_t i = 0; i < scratchCount; ++i)
+        zelReleaseScratch(&scratch[i]);
+    free(scratch);
+
+    for (size_t i = 0; i < jobCount; ++i) {
+        if (jobs[i].result != ZEL_OK)
+            return jobs[i].result;
+    }
+
+    return ZEL_OK;
+}
+
+typedef struct {
+    const ZELContext *ctx;
+    const uint32_t *groupStarts;
+    ZELResult *groupResults;
+    ZELScratch *scratch;
+    uint32_t scratchCount;
+    uint16_t *dst;
+    size_t dstStridePixels;
+    size_t dstFramePitchPixels;
+    uint16_t **frameBuffers;
+    ZELFrameSinkFunc sink;
+    void *sinkUserData;
+} ZELFrameRangeTaskData;
+
+static void zelRunFrameRangeGroup(void *taskData, uint32_t taskIndex, uint32_t workerIndex) {
+    ZELFrameRangeTaskData *range = (ZELFrameRangeTaskData *)taskData;
+    ZELResult result = ZEL_OK;
+
+    if (workerIndex >= range->scratchCount) {
+        range->groupResults[taskIndex] = ZEL_ERR_INTERNAL;
+        return;
+    }
+
+    ZELScratch *scratch = &range->scratch[workerIndex];
+    uint32_t begin = range->groupStarts[taskIndex];
+    uint32_t end = range->groupStarts[taskIndex + 1];
+
+    for (uint32_t frame = begin; frame < end && result == ZEL_OK; ++frame) {
+        if (range->sink) {
+            uint16_t *pixels = range->frameBuffers[workerIndex];
+            size_t stride = range->ctx->header.width;
+            result = zelDecodeFrameRgb565WithScratch(range->ctx, frame, scratch, pixels, stride);
+            if (result == ZEL_OK)
+                result = range->sink(range->sinkUserData, frame, pixels, stride, workerIndex);
+        } else {
+            size_t slot = (size_t)(frame - range->groupStarts[0]);
+            uint16_t *pixels = range->dst + slot * range->dstFramePitchPixels;
+            result = zelDecodeFrameRgb565WithScratch(range->ctx,
+                                                     frame,
+                                                     scratch,
+                                                     pixels,
+                                                     range->dstStridePixels);
+        }
+    }
+
+    range->groupResults[taskIndex] = result;
+}
+
+static ZELResult zelDecodeFrameRangeCommon(ZELFrameRangeTaskData *range,
+                                           uint32_t firstFrame,
+                                           uint32_t frameCount,
+                                           const ZELWorkerPool *pool) {
+    const ZELContext *ctx = range->ctx;
+
+    if (frameCount == 0)
+        return ZEL_OK;
+
+    if (firstFrame >= ctx->header.frameCount || frameCount > ctx->header.frameCount - firstFrame)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    ZELResult result = zelPrepareSharedPalette(ctx);
+    if (result != ZEL_OK)
+        return result;
+
+    int parallel = (pool && pool->run && pool->workerCount > 0);
+    uint32_t scratchCount = parallel ? pool->workerCount : 1;
+
+    /* Frames built on their predecessor stay in the task of the frame that leads them. */
+    uint32_t *groupStarts = (uint32_t *)malloc(((size_t)frameCount + 1) * sizeof(uint32_t));
+    ZELResult *groupResults = (ZELResult *)malloc((size_t)frameCount * sizeof(ZELResult));
+    ZELScratch *scratch = (ZELScratch *)calloc(scratchCount, sizeof(ZELScratch));
+    uint16_t **frameBuffers = NULL;
+    if (range->sink)
+        frameBuffers = (uint16_t **)calloc(scratchCount, sizeof(uint16_t *));
+
+    if (!groupStarts || !groupResults || !scratch || (range->sink && !frameBuffers)) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+
+    if (range->sink) {
+        size_t framePixels = (size_t)ctx->header.width * ctx->header.height;
+        for (uint32_t i = 0; i < scratchCount; ++i) {
+            frameBuffers[i] = (uint16_t *)malloc(framePixels * sizeof(uint16_t));
+            if (!frameBuffers[i]) {
+                result = ZEL_ERR_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+        }
+    }
+
+    uint32_t groupCount = 0;
+    for (uint32_t frame = firstFrame; frame < firstFrame + frameCount; ++frame) {
+        if (frame == firstFrame || !ctx->frameIndexTable[frame].flags.usePreviousFrameAsBase)
+            groupStarts[groupCount++] = frame;
+    }
+    groupStarts[groupCount] = firstFrame + frameCount;
+
+    for (uint32_t i = 0; i < groupCount; ++i)
+        groupResults[i] = ZEL_ERR_INTERNAL;
+
+    range->groupStarts = groupStarts;
+    range->groupResults = groupResults;
+    range->scratch = scratch;
+    range->scratchCount = scratchCount;
+    range->frameBuffers = frameBuffers;
+
+    if (parallel) {
+        pool->run(pool->userData, zelRunFrameRangeGroup, range, groupCount);
+    } else {
+        for (uint32_t i = 0; i < groupCount; ++i)
+            zelRunFrameRangeGroup(range, i, 0);
+    }
+
+    for (uint32_t i = 0; i < groupCount; ++i) {
+        if (groupResults[i] != ZEL_OK) {
+            result = groupResults[i];
+            break;
+        }
+    }
+
+cleanup:
+    if (frameBuffers) {
+        for (uint32_t i = 0; i < scratchCount; ++i)
+            free(frameBuffers[i]);
+        free(frameBuffers);
+    }
+    if (scratch) {
+        for (uint32_t i = 0; i < scratchCount; ++i)
+            zelReleaseScratch(&scratch[i]);
+        free(scratch);
+    }
+    free(groupResults);
+    free(groupStarts);
+    return result;
+}
+
+ZELResult zelDecodeFrameRangeRgb565(const ZELContext *ctx,
+                                    uint32_t firstFrame,
+                                    uint32_t frameCount,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels,
+                                    size_t dstFramePitchPixels,
+                                    const ZELWorkerPool *pool) {
+    if (!ctx || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (dstStridePixels < ctx->header.width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* Both products are checked so that a wrapped size can neither pass the pitch check nor
+       place a later frame outside dst. */
+    size_t maxPixels = SIZE_MAX / sizeof(uint16_t);
+    if (ctx->header.height > 0 && dstStridePixels > maxPixels / ctx->header.height)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (frameCount > 1 && dstFramePitchPixels < dstStridePixels * ctx->header.height)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (frameCount > 1 && dstFramePitchPixels > maxPixels / (frameCount - 1u))
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELFrameRangeTaskData range;
+    memset(&range, 0, sizeof(range));
+    range.ctx = ctx;
+    range.dst = dst;
+    range.dstStridePixels = dstStridePixels;
+    range.dstFramePitchPixels = dstFramePitchPixels;
+    return zelDecodeFrameRangeCommon(&range, firstFrame, frameCount, pool);
+}
+
+ZELResult zelDecodeFrameRangeRgb565ToSink(const ZELContext *ctx,
+                                          uint32_t firstFrame,
+                                          uint32_t frameCount,
+                                          ZELFrameSinkFunc sink,
+                                          void *sinkUserData,
+                                          const ZELWorkerPool *pool) {
+    if (!ctx || !sink)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELFrameRangeTaskData range;
+    memset(&range, 0, sizeof(range));
+    range.ctx = ctx;
+    range.sink = sink;
+    range.sinkUserData = sinkUserData;
+    return zelDecodeFrameRangeCommon(&range, firstFrame, frameCount, pool);
+}
+
+/* One band of consecutive zones of a scheduled job. */
+typedef struct {
+    uint32_t job;
+    uint32_t firstZone;
+    uint32_t endZone;
+    uint32_t finishUs;
+    ZELResult result;
+} ZELScheduledTask;
+
+struct ZELScheduler {
+    ZELWorkerPool pool;
+    int parallel;
+    ZELScratch *scratch;
+    uint32_t scratchCount;
+    ZELScheduledTask *tasks;
+    uint32_t taskCapacity;
+    uint32_t *order;
+    uint32_t orderCapacity;
+};
+
+typedef struct {
+    ZELScheduler *scheduler;
+    ZELScheduledJob *jobs;
+    ZELClockFunc clock;
+    void *clockUserData;
+} ZELScheduleTaskData;
+
+typedef struct {
+    const ZELScheduledTask *task;
+    const ZELBlitKernels *blit;
+    const uint16_t *palette;
+    uint16_t *dst;
+    size_t dstStridePixels;
+} ZELScheduledZoneTarget;
+
+ZELScheduler *zelCreateScheduler(const ZELWorkerPool *pool, ZELResult *outResult) {
+    ZELResult result = ZEL_OK;
+    ZELScheduler *scheduler = (ZELScheduler *)calloc(1, sizeof(ZELScheduler));
+    if (!scheduler) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    scheduler->parallel = (pool && pool->run && pool->workerCount > 0);
+    if (scheduler->parallel)
+        scheduler->pool = *pool;
+    scheduler->scratchCount = scheduler->parallel ? pool->workerCount : 1;
+
+    /* Scratch lives as long as the scheduler, so buffers grown by one run serve the next. */
+    scheduler->scratch = (ZELScratch *)calloc(scheduler->scratchCount, sizeof(ZELScratch));
+    if (!scheduler->scratch) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    if (outResult)
+        *outResult = ZEL_OK;
+    return scheduler;
+
+fail:
+    zelDestroyScheduler(scheduler);
+    if (outResult)
+        *outResult = result;
+    return NULL;
+}
+
+void zelDestroyScheduler(ZELScheduler *scheduler) {
+    if (!scheduler)
+        return;
+
+    if (scheduler->scratch) {
+        for (uint32_t i = 0; i < scheduler->scratchCount; ++i)
+            zelReleaseScratch(&scheduler->scratch[i]);
+        free(scheduler->scratch);
+    }
+    free(scheduler->tasks);
+    free(scheduler->order);
+    free(scheduler);
+}
+
+static int zelScheduledZoneInBand(void *userData, const ZELZoneLayout *layout, uint32_t zoneIndex) {
+    const ZELScheduledZoneTarget *target = (const ZELScheduledZoneTarget *)userData;
+    (void)layout;
+    return zoneIndex >= target->task->firstZone && zoneIndex < target->task->endZone;
+}
+
+static ZELResult zelBlitScheduledZone(void *userData,
+                                      const ZELZoneLayout *layout,
+                                      uint32_t zoneIndex,
+                                      const uint8_t *zonePixels) {
+    const ZELScheduledZoneTarget *target = (const ZELScheduledZoneTarget *)userData;
+    target->blit->rgbUnchecked(layout,
+                               zoneIndex,
+                               zonePixels,
+                               target->palette,
+                               target->dst,
+                               target->dstStridePixels);
+    return ZEL_OK;
+}
+
+static void zelRunScheduledTask(void *taskData, uint32_t taskIndex, uint32_t workerIndex) {
+    ZELScheduleTaskData *run = (ZELScheduleTaskData *)taskData;
+    ZELScheduler *scheduler = run->scheduler;
+    ZELScheduledTask *task = &scheduler->tasks[taskIndex];
+
+    if (workerIndex >= scheduler->scratchCount) {
+        task->result = ZEL_ERR_INTERNAL;
+        task->finishUs = run->clock(run->clockUserData);
+        return;
+    }
+
+    const ZELScheduledJob *job = &run->jobs[task->job];
+    ZELScratch *scratch = &scheduler->scratch[workerIndex];
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(job->ctx, job->frameIndex, scratch, &palette, &paletteCount);
+
+    /* The visit checks indices against small palettes; 256 or more entries need no check. */
+    if (result == ZEL_OK && paletteCount == 0)
+        result = ZEL_ERR_CORRUPT_DATA;
+
+    if (result == ZEL_OK) {
+        ZELScheduledZoneTarget target = {task, job->ctx->blit, palette, job->dst,
+                                         job->dstStridePixels};
+        result = zelVisitFrameZonesFiltered(job->ctx,
+                                            job->frameIndex,
+                                            scratch,
+                                            paletteCount,
+                                            zelScheduledZoneInBand,
+                                            zelBlitScheduledZone,
+                                            &target);
+    }
+
+    task->result = result;
+    task->finishUs = run->clock(run->clockUserData);
+}
+
+static uint32_t zelScheduledZoneCount(const ZELContext *ctx) {
+    const ZELFileHeader *h = &ctx->header;
+    return (uint32_t)(h->width / h->zoneWidth) * (h->height / h->zoneHeight);
+}
+
+/* Streamed contexts stay in one band: every band would re-read the whole frame. */
+static uint32_t zelScheduledBandCount(const ZELContext *ctx, uint32_t bandsPerFrame) {
+    uint32_t zoneCount = zelScheduledZoneCount(ctx);
+    uint32_t bands = ctx->data ? bandsPerFrame : 1;
+    return bands < zoneCount ? bands : zoneCount;
+}
+
+static ZELResult zelReserveSchedule(ZELScheduler *scheduler, uint32_t jobCount, size_t taskCount) {
+    if (taskCount > UINT32_MAX)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (jobCount > scheduler->orderCapacity) {
+        uint32_t *order = (uint32_t *)realloc(scheduler->order, jobCount * sizeof(uint32_t));
+        if (!order)
+            return ZEL_ERR_OUT_OF_MEMORY;
+        scheduler->order = order;
+        scheduler->orderCapacity = jobCount;
+    }
+
+    if (taskCount > scheduler->taskCapacity) {
+        ZELScheduledTask *tasks = (ZELScheduledTask *)realloc(scheduler->tasks,
+                                                              taskCount * sizeof(ZELScheduledTask));
+        if (!tasks)
+            return ZEL_ERR_OUT_OF_MEMORY;
+        scheduler->tasks = tasks;
+        scheduler->taskCapacity = (uint32_t)taskCount;
+    }
+
+    return ZEL_OK;
+}
+
+ZELResult zelSchedulerRun(ZELScheduler *scheduler,
+                          ZELScheduledJob *jobs,
+                          uint32_t jobCount,
+                          ZELClockFunc clock,
+                          void *clockUserData,
+                          ZELScheduleReport *outReport) {
+    if (!scheduler || (!jobs && jobCount > 0) || !clock)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    uint32_t startUs = clock(clockUserData);
+    uint32_t bandsPerFrame = scheduler->parallel ? scheduler->scratchCount : 1;
+
+    const ZELContext *preparedCtx = NULL;
+    size_t taskCount = 0;
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        ZELScheduledJob *job = &jobs[i];
+        job->finishUs = startUs;
+        job->missedDeadline = 0;
+        job->result = zelCheckDecodeTarget(job->ctx, job->frameIndex, job->dst,
+                                           job->dstStridePixels);
+        if (job->result == ZEL_OK && job->ctx != preparedCtx) {
+            job->result = zelPrepareSharedPalette(job->ctx);
+            preparedCtx = job->ctx;
+        }
+        if (job->result == ZEL_OK)
+            taskCount += zelScheduledBandCount(job->ctx, bandsPerFrame);
+    }
+
+    ZELResult result = zelReserveSchedule(scheduler, jobCount, taskCount);
+    if (result != ZEL_OK)
+        return result;
+
+    /* Earliest deadline first; deadlines already behind startUs sort before the rest. */
+    uint32_t *order = scheduler->order;
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        int32_t key = (int32_t)(jobs[i].deadlineUs - startUs);
+        uint32_t j = i;
+        while (j > 0 && (int32_t)(jobs[order[j - 1]].deadlineUs - startUs) > key) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    uint32_t taskIndex = 0;
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        const ZELScheduledJob *job = &jobs[order[i]];
+        if (job->result != ZEL_OK)
+            continue;
+
+        uint32_t zoneCount = zelScheduledZoneCount(job->ctx);
+        uint32_t bands = zelScheduledBandCount(job->ctx, bandsPerFrame);
+        for (uint32_t band = 0; band < bands; ++band) {
+            ZELScheduledTask *task = &scheduler->tasks[taskIndex++];
+            task->job = order[i];
+            task->firstZone = (uint32_t)((uint64_t)zoneCount * band / bands);
+            task->endZone = (uint32_t)((uint64_t)zoneCount * (band + 1) / bands);
+            task->finishUs = startUs;
+            task->result = ZEL_ERR_INTERNAL;
+        }
+    }
+
+    ZELScheduleTaskData run = {scheduler, jobs, clock, clockUserData};
+    if (scheduler->parallel && taskIndex > 0) {
+        scheduler->pool.run(scheduler->pool.userData, zelRunScheduledTask, &run, taskIndex);
+    } else {
+        for (uint32_t i = 0; i < taskIndex; ++i)
+            zelRunScheduledTask(&run, i, 0);
+    }
+
+    /* A job finishes with its last band; clock readings are compared relative to startUs. */
+    for (uint32_t i = 0; i < taskIndex; ++i) {
+        const ZELScheduledTask *task = &scheduler->tasks[i];
+        ZELScheduledJob *job = &jobs[task->job];
+        if (job->result == ZEL_OK && task->result != ZEL_OK)
+            job->result = task->result;
+        if (task->finishUs - startUs > job->finishUs - startUs)
+            job->finishUs = task->finishUs;
+    }
+
+    ZELScheduleReport report = {jobCount, taskIndex, 0, 0};
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        ZELScheduledJob *job = &jobs[i];
+        int32_t lateness = (int32_t)(job->finishUs - job->deadlineUs);
+        if (job->result != ZEL_OK || lateness <= 0)
+            continue;
+        job->missedDeadline = 1;
+        report.missedDeadlines++;
+        if ((uint32_t)lateness > report.worstLatenessUs)
+            report.worstLatenessUs = (uint32_t)lateness;
+    }
+
+    if (outReport)
+        *outReport = report;
+
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        if (jobs[i].result != ZEL_OK)
+            return jobs[i].result;
+    }
+    return ZEL_OK;
+}
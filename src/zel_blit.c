@@ -0,0 +1,540 @@
+#include "zel_internal.h"
+
+#include <string.h>
+
+static size_t zelZoneOriginOffset(const ZELZoneLayout *layout,
+                                  uint32_t zoneIndex,
+                                  size_t dstStride) {
+    uint32_t zonesPerRow = layout->zonesPerRow;
+    size_t zoneX = (size_t)(zoneIndex % zonesPerRow) * layout->zoneWidth;
+    size_t zoneY = (size_t)(zoneIndex / zonesPerRow) * layout->zoneHeight;
+    return zoneY * dstStride + zoneX;
+}
+
+static void zelBlitZoneIndices(const ZELZoneLayout *layout,
+                               uint32_t zoneIndex,
+                               const uint8_t *zonePixels,
+                               uint8_t *dst,
+                               size_t dstStrideBytes) {
+    uint8_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStrideBytes);
+
+    for (uint32_t row = 0; row < layout->zoneHeight; ++row) {
+        uint8_t *dstRow = base + (size_t)row * dstStrideBytes;
+        const uint8_t *srcRow = zonePixels + (size_t)row * layout->zoneWidth;
+        memcpy(dstRow, srcRow, layout->zoneWidth);
+    }
+}
+
+static ZELResult zelBlitZoneRgb(const ZELZoneLayout *layout,
+                                uint32_t zoneIndex,
+                                const uint8_t *zonePixels,
+                                const uint16_t *palette,
+                                uint16_t paletteCount,
+                                uint16_t *dst,
+                                size_t dstStridePixels) {
+    uint16_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStridePixels);
+    /* Local copies: stores through dst may otherwise alias the layout fields. */
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+
+    for (uint32_t row = 0; row < zoneHeight; ++row) {
+        uint16_t *dstRow = base + (size_t)row * dstStridePixels;
+        const uint8_t *srcRow = zonePixels + (size_t)row * zoneWidth;
+
+        for (uint32_t col = 0; col < zoneWidth; ++col) {
+            uint8_t idx = srcRow[col];
+            if (idx >= paletteCount)
+                return ZEL_ERR_CORRUPT_DATA;
+            dstRow[col] = palette[idx];
+        }
+    }
+
+    return ZEL_OK;
+}
+
+static void zelBlitZoneRgbUnchecked(const ZELZoneLayout *layout,
+                                    uint32_t zoneIndex,
+                                    const uint8_t *zonePixels,
+                                    const uint16_t *palette,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels) {
+    uint16_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStridePixels);
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+
+    for (uint32_t row = 0; row < zoneHeight; ++row) {
+        uint16_t *dstRow = base + (size_t)row * dstStridePixels;
+        const uint8_t *srcRow = zonePixels + (size_t)row * zoneWidth;
+        zelExpandRowRgb565(srcRow, palette, dstRow, zoneWidth);
+    }
+}
+
+/* Writes one zone into an oriented frame. The destination tile is filled row by row and the
+   source zone (small enough to stay in cache) is walked with signed steps, so rotation never
+   needs a second pass over the frame. */
+void zelBlitZoneRgbOriented(const ZELZoneLayout *layout,
+                            uint32_t zoneIndex,
+                            const uint8_t *zonePixels,
+                            const uint16_t *palette,
+                            ZELOrientation orientation,
+                            uint16_t *dst,
+                            size_t dstStridePixels) {
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+    size_t zoneX = (size_t)(zoneIndex % layout->zonesPerRow) * zoneWidth;
+    size_t zoneY = (size_t)(zoneIndex / layout->zonesPerRow) * zoneHeight;
+    size_t frameWidth = (size_t)layout->zonesPerRow * zoneWidth;
+    size_t frameHeight = (size_t)layout->zonesPerCol * zoneHeight;
+
+    int transpose = (orientation & ZEL_ORIENTATION_TRANSPOSE) != 0;
+    int flipX = (orientation & ZEL_ORIENTATION_FLIP_X) != 0;
+    int flipY = (orientation & ZEL_ORIENTATION_FLIP_Y) != 0;
+
+    /* Tile origin and size before flipping, in the (possibly transposed) output space. */
+    size_t tileX = transpose ? zoneY : zoneX;
+    size_t tileY = transpose ? zoneX : zoneY;
+    uint32_t tileWidth = transpose ? zoneHeight : zoneWidth;
+    uint32_t tileHeight = transpose ? zoneWidth : zoneHeight;
+    size_t outWidth = transpose ? frameHeight : frameWidth;
+    size_t outHeight = transpose ? frameWidth : frameHeight;
+    if (flipX)
+        tileX = outWidth - tileX - tileWidth;
+    if (flipY)
+        tileY = outHeight - tileY - tileHeight;
+
+    ptrdiff_t stepX = flipX ? -1 : 1;
+    ptrdiff_t stepY = flipY ? -1 : 1;
+    ptrdiff_t firstX = flipX ? (ptrdiff_t)tileWidth - 1 : 0;
+    ptrdiff_t firstY = flipY ? (ptrdiff_t)tileHeight - 1 : 0;
+    ptrdiff_t colStep, rowStep, start;
+    if (transpose) {
+        colStep = stepX * (ptrdiff_t)zoneWidth;
+        rowStep = stepY;
+        start = firstX * (ptrdiff_t)zoneWidth + firstY;
+    } else {
+        colStep = stepX;
+        rowStep = stepY * (ptrdiff_t)zoneWidth;
+        start = firstY * (ptrdiff_t)zoneWidth + firstX;
+    }
+
+    uint16_t *base = dst + tileY * dstStridePixels + tileX;
+    for (uint32_t row = 0; row < tileHeight; ++row) {
+        uint16_t *dstRow = base + (size_t)row * dstStridePixels;
+        ptrdiff_t srcOffset = start + (ptrdiff_t)row * rowStep;
+
+        if (colStep == 1) {
+            zelExpandRowRgb565(zonePixels + srcOffset, palette, dstRow, tileWidth);
+            continue;
+        }
+
+        for (uint32_t col = 0; col < tileWidth; ++col) {
+            dstRow[col] = palette[zonePixels[srcOffset]];
+            srcOffset += colStep;
+        }
+    }
+}
+
+/* Blends one zone onto dst. A zone whose entries are all transparent is skipped and an all-opaque
+   zone is a plain palette expansion; otherwise each pixel takes the cheap path for alpha 0 or 32
+   and the fields-in-one-word multiply for anything in between. */
+void zelBlendZoneRgb565(const ZELZoneLayout *layout,
+                        uint32_t zoneIndex,
+                        const uint8_t *zonePixels,
+                        const ZELBlendPalette *blend,
+                        int swapBytes,
+                        uint16_t *dst,
+                        size_t dstStridePixels) {
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+    size_t zonePixelCount = (size_t)zoneWidth * zoneHeight;
+
+    uint8_t kinds = 0;
+    for (size_t i = 0; i < zonePixelCount; ++i)
+        kinds |= blend->kind[zonePixels[i]];
+    if (kinds == ZEL_BLEND_TRANSPARENT)
+        return;
+
+    uint16_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStridePixels);
+    if (kinds == ZEL_BLEND_OPAQUE) {
+        for (uint32_t row = 0; row < zoneHeight; ++row)
+            zelExpandRowRgb565(zonePixels + (size_t)row * zoneWidth,
+                               blend->color,
+                               base + (size_t)row * dstStridePixels,
+                               zoneWidth);
+        return;
+    }
+
+    for (uint32_t row = 0; row < zoneHeight; ++row) {
+        uint16_t *dstRow = base + (size_t)row * dstStridePixels;
+        const uint8_t *srcRow = zonePixels + (size_t)row * zoneWidth;
+
+        for (uint32_t col = 0; col < zoneWidth; ++col) {
+            uint8_t idx = srcRow[col];
+            uint32_t alpha = blend->alpha[idx];
+            if (alpha == 0)
+                continue;
+            if (alpha == 32) {
+                dstRow[col] = blend->color[idx];
+                continue;
+            }
+
+            uint16_t under = swapBytes ? zelSwapRgb565(dstRow[col]) : dstRow[col];
+            uint32_t bg = (under | ((uint32_t)under << 16)) & 0x07E0F81Fu;
+            uint32_t mixed = ((((blend->spread[idx] - bg) * alpha) >> 5) + bg) & 0x07E0F81Fu;
+            uint16_t value = (uint16_t)(mixed | (mixed >> 16));
+            dstRow[col] = swapBytes ? zelSwapRgb565(value) : value;
+        }
+    }
+}
+
+typedef struct {
+    uint32_t zoneX;
+    uint32_t zoneY;
+    uint32_t left;
+    uint32_t top;
+    uint32_t right;
+    uint32_t bottom;
+} ZELZoneSpan;
+
+/* Intersects a zone with visible; returns 0 when they do not overlap. */
+static int zelClipZoneSpan(const ZELZoneLayout *layout,
+                           uint32_t zoneIndex,
+                           const ZELRect *visible,
+                           ZELZoneSpan *outSpan) {
+    uint32_t zoneX = (zoneIndex % layout->zonesPerRow) * layout->zoneWidth;
+    uint32_t zoneY = (zoneIndex / layout->zonesPerRow) * layout->zoneHeight;
+    uint32_t right = zoneX + layout->zoneWidth;
+    uint32_t bottom = zoneY + layout->zoneHeight;
+    if (right > (uint32_t)visible->x + visible->width)
+        right = (uint32_t)visible->x + visible->width;
+    if (bottom > (uint32_t)visible->y + visible->height)
+        bottom = (uint32_t)visible->y + visible->height;
+
+    outSpan->zoneX = zoneX;
+    outSpan->zoneY = zoneY;
+    outSpan->left = zoneX > visible->x ? zoneX : visible->x;
+    outSpan->top = zoneY > visible->y ? zoneY : visible->y;
+    outSpan->right = right;
+    outSpan->bottom = bottom;
+    return outSpan->left < right && outSpan->top < bottom;
+}
+
+/* Writes the part of one zone that falls inside visible (frame coordinates). dst addresses the
+   output pixel for the visible rectangle's top-left corner. */
+void zelBlitZoneRgbClipped(const ZELZoneLayout *layout,
+                           uint32_t zoneIndex,
+                           const uint8_t *zonePixels,
+                           const uint16_t *palette,
+                           const ZELRect *visible,
+                           uint16_t *dst,
+                           size_t dstStridePixels) {
+    ZELZoneSpan span;
+    if (!zelClipZoneSpan(layout, zoneIndex, visible, &span))
+        return;
+
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t count = span.right - span.left;
+    const uint8_t *src = zonePixels + (span.left - span.zoneX);
+    uint16_t *out = dst + (span.left - visible->x);
+    for (uint32_t y = span.top; y < span.bottom; ++y) {
+        const uint8_t *srcRow = src + (size_t)(y - span.zoneY) * zoneWidth;
+        uint16_t *dstRow = out + (size_t)(y - visible->y) * dstStridePixels;
+        zelExpandRowRgb565(srcRow, palette, dstRow, count);
+    }
+}
+
+/* As zelBlitZoneRgbClipped, but pixels holding the key index leave dst untouched. */
+void zelBlitZoneRgbKeyed(const ZELZoneLayout *layout,
+                         uint32_t zoneIndex,
+                         const uint8_t *zonePixels,
+                         const uint16_t *palette,
+                         uint8_t key,
+                         const ZELRect *visible,
+                         uint16_t *dst,
+                         size_t dstStridePixels) {
+    ZELZoneSpan span;
+    if (!zelClipZoneSpan(layout, zoneIndex, visible, &span))
+        return;
+
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t count = span.right - span.left;
+    const uint8_t *src = zonePixels + (span.left - span.zoneX);
+    uint16_t *out = dst + (span.left - visible->x);
+    for (uint32_t y = span.top; y < span.bottom; ++y) {
+        const uint8_t *srcRow = src + (size_t)(y - span.zoneY) * zoneWidth;
+        uint16_t *dstRow = out + (size_t)(y - visible->y) * dstStridePixels;
+        for (uint32_t col = 0; col < count; ++col) {
+            uint8_t idx = srcRow[col];
+            if (idx != key)
+                dstRow[col] = palette[idx];
+        }
+    }
+}
+
+/* memcpy with a constant size compiles to a single (unaligned) load and store. */
+#define ZEL_DEFINE_LUT_ROW(SIZE)                                                                   \
+    static void zelExpandRowLut##SIZE(const uint8_t *src,                                          \
+                                      const uint8_t *lut,                                          \
+                                      uint8_t *dst,                                                \
+                                      uint32_t count) {                                            \
+        for (uint32_t i = 0; i < count; ++i)                                                       \
+            memcpy(dst + (size_t)i * (SIZE), lut + (size_t)src[i] * (SIZE), (SIZE));               \
+    }
+
+ZEL_DEFINE_LUT_ROW(2)
+ZEL_DEFINE_LUT_ROW(3)
+ZEL_DEFINE_LUT_ROW(4)
+
+#undef ZEL_DEFINE_LUT_ROW
+
+static void zelExpandRowLut1(const uint8_t *src, const uint8_t *lut, uint8_t *dst, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i)
+        dst[i] = lut[src[i]];
+}
+
+void zelBlitZoneLut(const ZELZoneLayout *layout,
+                    uint32_t zoneIndex,
+                    const uint8_t *zonePixels,
+                    const uint8_t *lut,
+                    uint32_t elementSize,
+                    uint8_t *dst,
+                    size_t dstPitchBytes) {
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+    size_t zoneX = (size_t)(zoneIndex % layout->zonesPerRow) * zoneWidth;
+    size_t zoneY = (size_t)(zoneIndex / layout->zonesPerRow) * zoneHeight;
+    uint8_t *base = dst + zoneY * dstPitchBytes + zoneX * elementSize;
+
+    void (*expandRow)(const uint8_t *, const uint8_t *, uint8_t *, uint32_t) = NULL;
+    switch (elementSize) {
+        case 1:
+            expandRow = zelExpandRowLut1;
+            break;
+        case 2:
+            expandRow = zelExpandRowLut2;
+            break;
+        case 3:
+            expandRow = zelExpandRowLut3;
+            break;
+        default:
+            expandRow = zelExpandRowLut4;
+            break;
+    }
+
+    for (uint32_t row = 0; row < zoneHeight; ++row)
+        expandRow(zonePixels + (size_t)row * zoneWidth,
+                  lut,
+                  base + (size_t)row * dstPitchBytes,
+                  zoneWidth);
+}
+
+static void zelStoreNibble(uint8_t *row, size_t nibbleIndex, uint8_t value) {
+    uint8_t *byte = row + nibbleIndex / 2;
+    if (nibbleIndex & 1u)
+        *byte = (uint8_t)((*byte & 0xF0u) | value);
+    else
+        *byte = (uint8_t)((*byte & 0x0Fu) | (value << 4));
+}
+
+void zelBlitZonePacked(const ZELZoneLayout *layout,
+                       uint32_t zoneIndex,
+                       const uint8_t *zonePixels,
+                       const ZELPackedPalette *packed,
+                       uint8_t *dst,
+                       size_t dstStrideBytes) {
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+    size_t zoneX = (size_t)(zoneIndex % layout->zonesPerRow) * zoneWidth;
+    size_t zoneY = (size_t)(zoneIndex / layout->zonesPerRow) * zoneHeight;
+
+    if (!packed->nibbles) {
+        zelBlitZoneLut(layout, zoneIndex, zonePixels, packed->bytes[0], 3, dst, dstStrideBytes);
+        return;
+    }
+
+    /* 444: pixel x owns nibbles 3x..3x+2. Pairs starting on an even pixel fill three whole
+       bytes; a zone edge at an odd pixel falls back to nibble stores. */
+    for (uint32_t row = 0; row < zoneHeight; ++row) {
+        uint8_t *dstRow = dst + (zoneY + row) * dstStrideBytes;
+        const uint8_t *srcRow = zonePixels + (size_t)row * zoneWidth;
+        size_t x = zoneX;
+        uint32_t col = 0;
+
+        if ((x & 1u) && col < zoneWidth) {
+            const uint8_t *entry = packed->bytes[srcRow[col]];
+            zelStoreNibble(dstRow, x * 3, entry[0] & 0x0Fu);
+            zelStoreNibble(dstRow, x * 3 + 1, entry[1] >> 4);
+            zelStoreNibble(dstRow, x * 3 + 2, entry[1] & 0x0Fu);
+            ++col;
+            ++x;
+        }
+
+        for (; col + 1 < zoneWidth; col += 2, x += 2) {
+            const uint8_t *first = packed->bytes[srcRow[col]];
+            const uint8_t *second = packed->bytes[srcRow[col + 1]];
+            uint8_t *out = dstRow + x / 2 * 3;
+            out[0] = (uint8_t)((first[0] << 4) | (first[1] >> 4));
+            out[1] = (uint8_t)((first[1] << 4) | (second[0] & 0x0Fu));
+            out[2] = second[1];
+        }
+
+        if (col < zoneWidth) {
+            const uint8_t *entry = packed->bytes[srcRow[col]];
+            zelStoreNibble(dstRow, x * 3, entry[0] & 0x0Fu);
+            zelStoreNibble(dstRow, x * 3 + 1, entry[1] >> 4);
+            zelStoreNibble(dstRow, x * 3 + 2, entry[1] & 0x0Fu);
+        }
+    }
+}
+
+static inline uint8_t zelGrayValue(const ZELGrayPalette *gray, uint8_t idx, size_t x, size_t y) {
+    return (uint8_t)(gray->level[idx] + ((gray->mask[idx] >> (((y & 3u) << 2) | (x & 3u))) & 1u));
+}
+
+/* Packed gray pixels are gathered into a byte and merged once per destination byte, so zone
+   edges that split a byte cost one read-modify-write instead of one per pixel. */
+void zelBlitZoneGray(const ZELZoneLayout *layout,
+                     uint32_t zoneIndex,
+                     const uint8_t *zonePixels,
+                     const ZELGrayPalette *gray,
+                     ZELGrayFormat format,
+                     uint8_t *dst,
+                     size_t dstStrideBytes) {
+    uint32_t zoneWidth = layout->zoneWidth;
+    uint32_t zoneHeight = layout->zoneHeight;
+    size_t zoneX = (size_t)(zoneIndex % layout->zonesPerRow) * zoneWidth;
+    size_t zoneY = (size_t)(zoneIndex / layout->zonesPerRow) * zoneHeight;
+
+    if (format == ZEL_GRAY_MONO1_PAGES) {
+        for (uint32_t col = 0; col < zoneWidth; ++col) {
+            size_t x = zoneX + col;
+            uint8_t *out = NULL;
+            uint8_t bits = 0;
+            uint8_t written = 0;
+            for (uint32_t row = 0; row < zoneHeight; ++row) {
+                size_t y = zoneY + row;
+                uint8_t *byte = dst + (y >> 3) * dstStrideBytes + x;
+                if (byte != out) {
+                    if (out)
+                        *out = (uint8_t)((*out & ~written) | bits);
+                    out = byte;
+                    bits = 0;
+                    written = 0;
+                }
+                uint8_t bit = (uint8_t)(1u << (y & 7u));
+                if (zelGrayValue(gray, zonePixels[(size_t)row * zoneWidth + col], x, y))
+                    bits |= bit;
+                written |= bit;
+            }
+            if (out)
+                *out = (uint8_t)((*out & ~written) | bits);
+        }
+        return;
+    }
+
+    uint32_t bitsPerPixel = format == ZEL_GRAY_GRAY4_ROWS ? 4u : 1u;
+    uint8_t pixelMask = (uint8_t)((1u << bitsPerPixel) - 1u);
+    for (uint32_t row = 0; row < zoneHeight; ++row) {
+        size_t y = zoneY + row;
+        uint8_t *dstRow = dst + y * dstStrideBytes;
+        const uint8_t *srcRow = zonePixels + (size_t)row * zoneWidth;
+        uint8_t *out = NULL;
+        uint8_t bits = 0;
+        uint8_t written = 0;
+        for (uint32_t col = 0; col < zoneWidth; ++col) {
+            size_t x = zoneX + col;
+            size_t bitOffset = x * bitsPerPixel;
+            uint8_t *byte = dstRow + bitOffset / 8;
+            if (byte != out) {
+                if (out)
+                    *out = (uint8_t)((*out & ~written) | bits);
+                out = byte;
+                bits = 0;
+                written = 0;
+            }
+            uint32_t shift = 8u - bitsPerPixel - (uint32_t)(bitOffset & 7u);
+            bits |= (uint8_t)(zelGrayValue(gray, srcRow[col], x, y) << shift);
+            written |= (uint8_t)(pixelMask << shift);
+        }
+        if (out)
+            *out = (uint8_t)((*out & ~written) | bits);
+    }
+}
+
+static const ZELBlitKernels zelBlitKernelsGeneric = {
+        zelBlitZoneIndices,
+        zelBlitZoneRgb,
+        zelBlitZoneRgbUnchecked,
+};
+
+/* Build with e.g. -D'ZEL_FIXED_ZONE_SIZES(X)=X(16, 16) X(32, 8)' to get kernels whose zone
+   geometry is a compile-time constant, so the row and column loops can be fully unrolled. */
+#ifdef ZEL_FIXED_ZONE_SIZES
+
+#define ZEL_DEFINE_FIXED_BLIT_KERNELS(W, H)                                                        \
+    static void zelBlitZoneIndices##W##x##H(const ZELZoneLayout *layout,                           \
+                                            uint32_t zoneIndex,                                    \
+                                            const uint8_t *zonePixels,                             \
+                                            uint8_t *dst,                                          \
+                                            size_t dstStrideBytes) {                               \
+        uint8_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStrideBytes);              \
+        for (uint32_t row = 0; row < (H); ++row)                                                   \
+            memcpy(base + (size_t)row * dstStrideBytes, zonePixels + (size_t)row * (W), (W));      \
+    }                                                                                              \
+                                                                                                   \
+    static void zelBlitZoneRgbUnchecked##W##x##H(const ZELZoneLayout *layout,                      \
+                                                 uint32_t zoneIndex,                               \
+                                                 const uint8_t *zonePixels,                        \
+                                                 const uint16_t *palette,                          \
+                                                 uint16_t *dst,                                    \
+                                                 size_t dstStridePixels) {                         \
+        uint16_t *base = dst + zelZoneOriginOffset(layout, zoneIndex, dstStridePixels);            \
+        for (uint32_t row = 0; row < (H); ++row) {                                                 \
+            uint16_t *dstRow = base + (size_t)row * dstStridePixels;                               \
+            zelExpandRowRgb565(zonePixels + (size_t)row * (W), palette, dstRow, (W));              \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static ZELResult zelBlitZoneRgb##W##x##H(const ZELZoneLayout *layout,                          \
+                                             uint32_t zoneIndex,                                   \
+                                             const uint8_t *zonePixels,                            \
+                                             const uint16_t *palette,                              \
+                                             uint16_t paletteCount,                                \
+                                             uint16_t *dst,                                        \
+                                             size_t dstStridePixels) {                             \
+        if (zelMaxIndex8(zonePixels, (W) * (H)) >= paletteCount)                                   \
+            return ZEL_ERR_CORRUPT_DATA;                                                           \
+        zelBlitZoneRgbUnchecked##W##x##H(layout,                                                   \
+                                         zoneIndex,                                                \
+                                         zonePixels,                                               \
+                                         palette,                                                  \
+                                         dst,                                                      \
+                                         dstStridePixels);                                         \
+        return ZEL_OK;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    static const ZELBlitKernels zelBlitKernels##W##x##H = {                                        \
+            zelBlitZoneIndices##W##x##H,                                                           \
+            zelBlitZoneRgb##W##x##H,                                                               \
+            zelBlitZoneRgbUnchecked##W##x##H,                                                      \
+    };
+
+ZEL_FIXED_ZONE_SIZES(ZEL_DEFINE_FIXED_BLIT_KERNELS)
+
+#endif /* ZEL_FIXED_ZONE_SIZES */
+
+const ZELBlitKernels *zelSelectBlitKernels(uint16_t zoneWidth, uint16_t zoneHeight) {
+#ifdef ZEL_FIXED_ZONE_SIZES
+#define ZEL_MATCH_FIXED_BLIT_KERNELS(W, H)                                                         \
+    if (zoneWidth == (W) && zoneHeight == (H))                                                     \
+        return &zelBlitKernels##W##x##H;
+
+    ZEL_FIXED_ZONE_SIZES(ZEL_MATCH_FIXED_BLIT_KERNELS)
+
+#undef ZEL_MATCH_FIXED_BLIT_KERNELS
+#else
+    (void)zoneWidth;
+    (void)zoneHeight;
+#endif
+    return &zelBlitKernelsGeneric;
+}
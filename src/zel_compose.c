@@ -0,0 +1,438 @@
+#include "zel_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Layers are drawn into a fixed grid of tiles. A tile is redrawn only when a layer overlapping
+   it changed since the previous composite. Within a redrawn tile, layers under the topmost
+   opaque layer that covers the whole tile are skipped before any of their zones are decoded. */
+struct ZELCompositor {
+    uint16_t width;
+    uint16_t height;
+    uint16_t tileSize;
+    uint32_t tilesPerRow;
+    uint32_t tileCount;
+    uint8_t *dirty;
+    /* 1 + sorted index of the topmost opaque layer covering each tile, or 0. */
+    uint32_t *cover;
+
+    ZELLayer *layers;
+    ZELLayer *previous;
+    uint32_t layerCapacity;
+    uint32_t previousCount;
+
+    int valid;
+    uint16_t background;
+    const uint16_t *lastDst;
+    size_t lastStride;
+};
+
+typedef struct {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+} ZELScreenBox;
+
+typedef struct {
+    uint32_t left;
+    uint32_t top;
+    uint32_t right;
+    uint32_t bottom;
+} ZELTileRange;
+
+typedef struct {
+    ZELCompositor *compositor;
+    const ZELLayer *layer;
+    uint32_t coverLimit;
+    const uint16_t *palette;
+    uint16_t *dst;
+    size_t dstStridePixels;
+} ZELCompositeTarget;
+
+ZELCompositor *zelCreateCompositor(uint16_t width,
+                                   uint16_t height,
+                                   uint16_t tileSize,
+                                   ZELResult *outResult) {
+    ZELResult result = ZEL_OK;
+    ZELCompositor *compositor = NULL;
+
+    if (width == 0 || height == 0 || tileSize == 0) {
+        result = ZEL_ERR_INVALID_ARGUMENT;
+        goto fail;
+    }
+
+    compositor = (ZELCompositor *)malloc(sizeof(ZELCompositor));
+    if (!compositor) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    memset(compositor, 0, sizeof(ZELCompositor));
+    compositor->width = width;
+    compositor->height = height;
+    compositor->tileSize = tileSize;
+    compositor->tilesPerRow = ((uint32_t)width + tileSize - 1) / tileSize;
+    compositor->tileCount =
+            compositor->tilesPerRow * (((uint32_t)height + tileSize - 1) / tileSize);
+    compositor->dirty = (uint8_t *)malloc(compositor->tileCount);
+    compositor->cover = (uint32_t *)malloc((size_t)compositor->tileCount * sizeof(uint32_t));
+    if (!compositor->dirty || !compositor->cover) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    if (outResult)
+        *outResult = ZEL_OK;
+    return compositor;
+
+fail:
+    zelDestroyCompositor(compositor);
+    if (outResult)
+        *outResult = result;
+    return NULL;
+}
+
+void zelDestroyCompositor(ZELCompositor *compositor) {
+    if (!compositor)
+        return;
+
+    free(compositor->dirty);
+    free(compositor->cover);
+    free(compositor->layers);
+    free(compositor->previous);
+    free(compositor);
+}
+
+void zelCompositorInvalidate(ZELCompositor *compositor) {
+    if (compositor)
+        compositor->valid = 0;
+}
+
+/* Screen area of a layer, clipped to the compositor; returns 0 when nothing is on screen. */
+static int zelLayerScreenBox(const ZELCompositor *compositor,
+                             const ZELLayer *layer,
+                             ZELScreenBox *outBox) {
+    int64_t left = layer->x;
+    int64_t top = layer->y;
+    int64_t right = left + layer->ctx->header.width;
+    int64_t bottom = top + layer->ctx->header.height;
+    outBox->left = (int32_t)(left < 0 ? 0 : left);
+    outBox->top = (int32_t)(top < 0 ? 0 : top);
+    outBox->right = (int32_t)(right > compositor->width ? compositor->width : right);
+    outBox->bottom = (int32_t)(bottom > compositor->height ? compositor->height : bottom);
+    return outBox->left < outBox->right && outBox->top < outBox->bottom;
+}
+
+/* Inclusive range of tiles touched by a non-empty on-screen box. */
+static void zelTileRangeOf(const ZELCompositor *compositor,
+                           const ZELScreenBox *box,
+                           ZELTileRange *outRange) {
+    uint32_t tileSize = compositor->tileSize;
+    outRange->left = (uint32_t)box->left / tileSize;
+    outRange->top = (uint32_t)box->top / tileSize;
+    outRange->right = (uint32_t)(box->right - 1) / tileSize;
+    outRange->bottom = (uint32_t)(box->bottom - 1) / tileSize;
+}
+
+static void zelMarkLayerDirty(ZELCompositor *compositor, const ZELLayer *layer) {
+    ZELScreenBox box;
+    if (!zelLayerScreenBox(compositor, layer, &box))
+        return;
+
+    ZELTileRange range;
+    zelTileRangeOf(compositor, &box, &range);
+    for (uint32_t ty = range.top; ty <= range.bottom; ++ty) {
+        for (uint32_t tx = range.left; tx <= range.right; ++tx)
+            compositor->dirty[ty * compositor->tilesPerRow + tx] = 1;
+    }
+}
+
+static int zelTileNeedsLayer(const ZELCompositor *compositor, uint32_t tile, uint32_t coverLimit) {
+    return compositor->dirty[tile] && compositor->cover[tile] <= coverLimit;
+}
+
+/* Whether any tile under box is redrawn and not hidden by an opaque layer above coverLimit. */
+static int zelBoxNeedsLayer(const ZELCompositor *compositor,
+                            const ZELScreenBox *box,
+                            uint32_t coverLimit) {
+    ZELTileRange range;
+    zelTileRangeOf(compositor, box, &range);
+    for (uint32_t ty = range.top; ty <= range.bottom; ++ty) {
+        for (uint32_t tx = range.left; tx <= range.right; ++tx) {
+            if (zelTileNeedsLayer(compositor, ty * compositor->tilesPerRow + tx, coverLimit))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+static int zelLayersEqual(const ZELLayer *a, const ZELLayer *b) {
+    return a->ctx == b->ctx && a->frameIndex == b->frameIndex && a->x == b->x && a->y == b->y &&
+           a->z == b->z && a->transparentIndex == b->transparentIndex;
+}
+
+static void zelTileBox(const ZELCompositor *compositor, uint32_t tile, ZELScreenBox *outBox) {
+    uint32_t tileSize = compositor->tileSize;
+    outBox->left = (int32_t)((tile % compositor->tilesPerRow) * tileSize);
+    outBox->top = (int32_t)((tile / compositor->tilesPerRow) * tileSize);
+    outBox->right = outBox->left + (int32_t)tileSize;
+    outBox->bottom = outBox->top + (int32_t)tileSize;
+    if (outBox->right > compositor->width)
+        outBox->right = compositor->width;
+    if (outBox->bottom > compositor->height)
+        outBox->bottom = compositor->height;
+}
+
+/* Screen area of one zone of a layer; returns 0 when it is entirely off screen. */
+static int zelZoneScreenBox(const ZELCompositeTarget *target,
+                            const ZELZoneLayout *layout,
+                            uint32_t zoneIndex,
+                            ZELScreenBox *outBox) {
+    const ZELCompositor *compositor = target->compositor;
+    int64_t left = target->layer->x +
+                   (int64_t)(zoneIndex % layout->zonesPerRow) * layout->zoneWidth;
+    int64_t top = target->layer->y +
+                  (int64_t)(zoneIndex / layout->zonesPerRow) * layout->zoneHeight;
+    int64_t right = left + layout->zoneWidth;
+    int64_t bottom = top + layout->zoneHeight;
+    outBox->left = (int32_t)(left < 0 ? 0 : left);
+    outBox->top = (int32_t)(top < 0 ? 0 : top);
+    outBox->right = (int32_t)(right > compositor->width ? compositor->width : right);
+    outBox->bottom = (int32_t)(bottom > compositor->height ? compositor->height : bottom);
+    return outBox->left < outBox->right && outBox->top < outBox->bottom;
+}
+
+static int zelCompositeZoneNeeded(void *userData, const ZELZoneLayout *layout, uint32_t zoneIndex) {
+    const ZELCompositeTarget *target = (const ZELCompositeTarget *)userData;
+    ZELScreenBox box;
+    return zelZoneScreenBox(target, layout, zoneIndex, &box) &&
+           zelBoxNeedsLayer(target->compositor, &box, target->coverLimit);
+}
+
+static ZELResult zelCompositeZone(void *userData,
+                                  const ZELZoneLayout *layout,
+                                  uint32_t zoneIndex,
+                                  const uint8_t *zonePixels) {
+    const ZELCompositeTarget *target = (const ZELCompositeTarget *)userData;
+    const ZELCompositor *compositor = target->compositor;
+    const ZELLayer *layer = target->layer;
+    ZELScreenBox box;
+    if (!zelZoneScreenBox(target, layout, zoneIndex, &box))
+        return ZEL_OK;
+
+    ZELTileRange range;
+    zelTileRangeOf(compositor, &box, &range);
+    for (uint32_t ty = range.top; ty <= range.bottom; ++ty) {
+        for (uint32_t tx = range.left; tx <= range.right; ++tx) {
+            uint32_t tile = ty * compositor->tilesPerRow + tx;
+            if (!zelTileNeedsLayer(compositor, tile, target->coverLimit))
+                continue;
+
+            ZELScreenBox tileBox;
+            zelTileBox(compositor, tile, &tileBox);
+            int32_t left = box.left > tileBox.left ? box.left : tileBox.left;
+            int32_t top = box.top > tileBox.top ? box.top : tileBox.top;
+            int32_t right = box.right < tileBox.right ? box.right : tileBox.right;
+            int32_t bottom = box.bottom < tileBox.bottom ? box.bottom : tileBox.bottom;
+
+            /* The blit kernels take the rectangle in frame coordinates. */
+            ZELRect visible = {(uint16_t)(left - layer->x), (uint16_t)(top - layer->y),
+                               (uint16_t)(right - left), (uint16_t)(bottom - top)};
+            uint16_t *dst = target->dst + (size_t)top * target->dstStridePixels + (size_t)left;
+            if (layer->transparentIndex < 0) {
+                zelBlitZoneRgbClipped(layout,
+                                      zoneIndex,
+                                      zonePixels,
+                                      target->palette,
+                                      &visible,
+                                      dst,
+                                      target->dstStridePixels);
+            } else {
+                zelBlitZoneRgbKeyed(layout,
+                                    zoneIndex,
+                                    zonePixels,
+                                    target->palette,
+                                    (uint8_t)layer->transparentIndex,
+                                    &visible,
+                                    dst,
+                                    target->dstStridePixels);
+            }
+        }
+    }
+    return ZEL_OK;
+}
+
+static ZELResult zelCheckLayer(const ZELLayer *layer) {
+    if (!layer->ctx || layer->transparentIndex > UINT8_MAX)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (layer->ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (layer->frameIndex >= layer->ctx->header.frameCount)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    return ZEL_OK;
+}
+
+/* Copies layers into compositor->layers ordered by z, keeping input order for equal z. */
+static ZELResult zelSortLayers(ZELCompositor *compositor,
+                               const ZELLayer *layers,
+                               uint32_t layerCount) {
+    if (layerCount > compositor->layerCapacity) {
+        ZELLayer *grown = (ZELLayer *)realloc(compositor->layers, layerCount * sizeof(ZELLayer));
+        if (!grown)
+            return ZEL_ERR_OUT_OF_MEMORY;
+        compositor->layers = grown;
+
+        grown = (ZELLayer *)realloc(compositor->previous, layerCount * sizeof(ZELLayer));
+        if (!grown)
+            return ZEL_ERR_OUT_OF_MEMORY;
+        compositor->previous = grown;
+        compositor->layerCapacity = layerCount;
+    }
+
+    ZELLayer *sorted = compositor->layers;
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1].z > layers[i].z) {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = layers[i];
+    }
+    return ZEL_OK;
+}
+
+ZELResult zelComposite(ZELCompositor *compositor,
+                       const ZELLayer *layers,
+                       uint32_t layerCount,
+                       uint16_t background,
+                       uint16_t *dst,
+                       size_t dstStridePixels,
+                       uint32_t *outTilesDrawn) {
+    if (!compositor || (!layers && layerCount > 0) || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (dstStridePixels < compositor->width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        ZELResult result = zelCheckLayer(&layers[i]);
+        if (result != ZEL_OK)
+            return result;
+    }
+
+    /* The previous composite must still be in dst for unchanged tiles to be reused. Until the
+       new layer list is stored, a failure leaves the whole screen to be redrawn next time. */
+    if (dst != compositor->lastDst || dstStridePixels != compositor->lastStride ||
+        background != compositor->background)
+        compositor->valid = 0;
+    int wasValid = compositor->valid;
+    compositor->valid = 0;
+
+    ZELResult result = zelSortLayers(compositor, layers, layerCount);
+    if (result != ZEL_OK)
+        return result;
+
+    ZELLayer *current = compositor->layers;
+    if (!wasValid) {
+        memset(compositor->dirty, 1, compositor->tileCount);
+    } else {
+        memset(compositor->dirty, 0, compositor->tileCount);
+        uint32_t count = layerCount > compositor->previousCount ? layerCount
+                                                                : compositor->previousCount;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (i < layerCount && i < compositor->previousCount &&
+                zelLayersEqual(&current[i], &compositor->previous[i]))
+                continue;
+            if (i < layerCount)
+                zelMarkLayerDirty(compositor, &current[i]);
+            if (i < compositor->previousCount)
+                zelMarkLayerDirty(compositor, &compositor->previous[i]);
+        }
+    }
+
+    /* Find the topmost opaque layer that covers each tile. */
+    memset(compositor->cover, 0, (size_t)compositor->tileCount * sizeof(uint32_t));
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        ZELScreenBox box;
+        if (current[i].transparentIndex >= 0 || !zelLayerScreenBox(compositor, &current[i], &box))
+            continue;
+        ZELTileRange range;
+        zelTileRangeOf(compositor, &box, &range);
+        for (uint32_t ty = range.top; ty <= range.bottom; ++ty) {
+            for (uint32_t tx = range.left; tx <= range.right; ++tx) {
+                uint32_t tile = ty * compositor->tilesPerRow + tx;
+                ZELScreenBox tileBox;
+                zelTileBox(compositor, tile, &tileBox);
+                if (box.left <= tileBox.left && box.top <= tileBox.top &&
+                    box.right >= tileBox.right && box.bottom >= tileBox.bottom)
+                    compositor->cover[tile] = i + 1;
+            }
+        }
+    }
+
+    uint32_t tilesDrawn = 0;
+    for (uint32_t tile = 0; tile < compositor->tileCount; ++tile) {
+        if (!compositor->dirty[tile])
+            continue;
+        ++tilesDrawn;
+        if (compositor->cover[tile] != 0)
+            continue;
+
+        ZELScreenBox tileBox;
+        zelTileBox(compositor, tile, &tileBox);
+        for (int32_t y = tileBox.top; y < tileBox.bottom; ++y) {
+            uint16_t *row = dst + (size_t)y * dstStridePixels;
+            for (int32_t x = tileBox.left; x < tileBox.right; ++x)
+                row[x] = background;
+        }
+    }
+
+    for (uint32_t i = 0; i < layerCount && result == ZEL_OK; ++i) {
+        ZELScreenBox box;
+        if (!zelLayerScreenBox(compositor, &current[i], &box) ||
+            !zelBoxNeedsLayer(compositor, &box, i + 1))
+            continue;
+
+        const ZELContext *ctx = current[i].ctx;
+        ZELScratch *scratchSet = zelContextScratch(ctx);
+        const uint16_t *palette = NULL;
+        uint16_t paletteCount = 0;
+        result = zelResolveFramePalette(ctx,
+                                        current[i].frameIndex,
+                                        scratchSet,
+                                        &palette,
+                                        &paletteCount);
+        if (result != ZEL_OK)
+            break;
+
+        ZELCompositeTarget target = {compositor, &current[i], i + 1, palette, dst,
+                                     dstStridePixels};
+        result = zelVisitFrameZonesFiltered(ctx,
+                                            current[i].frameIndex,
+                                            scratchSet,
+                                            paletteCount,
+                                            zelCompositeZoneNeeded,
+                                            zelCompositeZone,
+                                            &target);
+    }
+
+    if (result != ZEL_OK)
+        return result;
+
+    ZELLayer *swap = compositor->previous;
+    compositor->previous = compositor->layers;
+    compositor->layers = swap;
+    compositor->previousCount = layerCount;
+    compositor->background = background;
+    compositor->lastDst = dst;
+    compositor->lastStride = dstStridePixels;
+    compositor->valid = 1;
+
+    if (outTilesDrawn)
+        *outTilesDrawn = tilesDrawn;
+    return ZEL_OK;
+}
@@ -4,6 +4,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* Sequential read size of a preload when the caller does not choose one. */
+#define ZEL_PRELOAD_DEFAULT_CHUNK ((size_t)64u * 1024u)
+
 static int zelValidateHeader(const ZELFileHeader *h) {
     if (memcmp(h->magic, "ZEL0", 4) != 0)
         return 0;
@@ -30,6 +33,11 @@ static int zelValidateHeader(const ZELFileHeader *h) {
 }
 
 int zelIsValidColorEncoding(uint8_t encoding) {
+    return encoding == ZEL_COLOR_RGB565_LE || encoding == ZEL_COLOR_RGB565_BE
+           || encoding == ZEL_COLOR_ARGB4444_LE;
+}
+
+int zelIsValidOutputEncoding(uint8_t encoding) {
     return encoding == ZEL_COLOR_RGB565_LE || encoding == ZEL_COLOR_RGB565_BE;
 }
 
@@ -49,7 +57,7 @@ ZELResult zelReadAt(const ZELContext *ctx, size_t offset, void *dst, size_t leng
     if (length == 0)
         return ZEL_OK;
 
-    if (!zelRangeFits(offset, length, ctx->size))
+    if (!ctx->trusted && !zelRangeFits(offset, length, ctx->size))
         return ZEL_ERR_CORRUPT_DATA;
 
     if (ctx->data) {
@@ -57,6 +65,12 @@ ZELResult zelReadAt(const ZELContext *ctx, size_t offset, void *dst, size_t leng
         return ZEL_OK;
     }
 
+    if (ctx->preload && length <= ctx->preloadedBytes
+        && offset <= ctx->preloadedBytes - length) {
+        memcpy(dst, ctx->preload + offset, length);
+        return ZEL_OK;
+    }
+
     if (!ctx->stream.read)
         return ZEL_ERR_INTERNAL;
 
@@ -82,40 +96,186 @@ static ZELContext *zelCreateContext(void) {
 ZELColorEncoding zelSelectOutputEncoding(const ZELContext *ctx, ZELColorEncoding sourceEncoding) {
     if (ctx->hasCustomOutputEncoding)
         return ctx->outputColorEncoding;
+    if (sourceEncoding == ZEL_COLOR_ARGB4444_LE)
+        return ZEL_COLOR_RGB565_LE;
     return sourceEncoding;
 }
 
-uint8_t *zelAcquireZoneScratch(const ZELContext *ctx, size_t neededBytes) {
-    if (!ctx || neededBytes == 0)
+ZELScratch *zelContextScratch(const ZELContext *ctx) {
+    if (!ctx)
+        return NULL;
+    return &((ZELContext *)ctx)->scratch;
+}
+
+uint8_t *zelAcquireZoneScratch(ZELScratch *scratch, size_t neededBytes) {
+    if (!scratch || neededBytes == 0)
+        return NULL;
+
+    if (scratch->zoneCapacity < neededBytes) {
+        uint8_t *newBuf = (uint8_t *)realloc(scratch->zone, neededBytes);
+        if (!newBuf)
+            return NULL;
+        scratch->zone = newBuf;
+        scratch->zoneCapacity = neededBytes;
+    }
+
+    return scratch->zone;
+}
+
+uint8_t *zelAcquireFrameDataScratch(ZELScratch *scratch, size_t neededBytes) {
+    if (!scratch || neededBytes == 0)
         return NULL;
 
-    ZELContext *mutableCtx = (ZELContext *)ctx;
-    if (mutableCtx->zoneScratchCapacity < neededBytes) {
-        uint8_t *newBuf = (uint8_t *)realloc(mutableCtx->zoneScratch, neededBytes);
+    if (scratch->frameDataCapacity < neededBytes) {
+        uint8_t *newBuf = (uint8_t *)realloc(scratch->frameData, neededBytes);
         if (!newBuf)
             return NULL;
-        mutableCtx->zoneScratch = newBuf;
-        mutableCtx->zoneScratchCapacity = neededBytes;
+        scratch->frameData = newBuf;
+        scratch->frameDataCapacity = neededBytes;
     }
 
-    return mutableCtx->zoneScratch;
+    return scratch->frameData;
 }
 
-uint16_t *zelAcquirePaletteScratch(const ZELContext *ctx, size_t neededEntries) {
-    if (!ctx || neededEntries == 0)
+uint16_t *zelAcquirePaletteScratch(ZELScratch *scratch, size_t neededEntries) {
+    if (!scratch || neededEntries == 0)
         return NULL;
 
-    ZELContext *mutableCtx = (ZELContext *)ctx;
-    if (mutableCtx->paletteScratchCapacity < neededEntries) {
+    if (scratch->paletteCapacity < neededEntries) {
         size_t neededBytes = neededEntries * sizeof(uint16_t);
-        uint16_t *newBuf = (uint16_t *)realloc(mutableCtx->paletteScratch, neededBytes);
+        uint16_t *newBuf = (uint16_t *)realloc(scratch->palette, neededBytes);
         if (!newBuf)
             return NULL;
-        mutableCtx->paletteScratch = newBuf;
-        mutableCtx->paletteScratchCapacity = neededEntries;
+        scratch->palette = newBuf;
+        scratch->paletteCapacity = neededEntries;
     }
 
-    return mutableCtx->paletteScratch;
+    return scratch->palette;
+}
+
+uint16_t *zelAcquireZoneRgbScratch(ZELScratch *scratch, size_t neededPixels) {
+    if (!scratch || neededPixels == 0)
+        return NULL;
+
+    if (scratch->zoneRgbCapacity < neededPixels) {
+        size_t neededBytes = neededPixels * sizeof(uint16_t);
+        uint16_t *newBuf = (uint16_t *)realloc(scratch->zoneRgb, neededBytes);
+        if (!newBuf)
+            return NULL;
+        scratch->zoneRgb = newBuf;
+        scratch->zoneRgbCapacity = neededPixels;
+    }
+
+    return scratch->zoneRgb;
+}
+
+ZELBlendPalette *zelAcquireBlendScratch(ZELScratch *scratch) {
+    if (!scratch)
+        return NULL;
+
+    if (!scratch->blend)
+        scratch->blend = (ZELBlendPalette *)malloc(sizeof(ZELBlendPalette));
+
+    return scratch->blend;
+}
+
+ZELPackedPalette *zelAcquirePackedScratch(ZELScratch *scratch) {
+    if (!scratch)
+        return NULL;
+
+    if (!scratch->packed)
+        scratch->packed = (ZELPackedPalette *)malloc(sizeof(ZELPackedPalette));
+
+    return scratch->packed;
+}
+
+ZELGrayPalette *zelAcquireGrayScratch(ZELScratch *scratch) {
+    if (!scratch)
+        return NULL;
+
+    if (!scratch->gray)
+        scratch->gray = (ZELGrayPalette *)malloc(sizeof(ZELGrayPalette));
+
+    return scratch->gray;
+}
+
+ZELChunkRange *zelAcquireChunkRangeScratch(ZELScratch *scratch, size_t neededRanges) {
+    if (!scratch || neededRanges == 0)
+        return NULL;
+
+    if (scratch->chunkRangeCapacity < neededRanges) {
+        if (neededRanges > SIZE_MAX / sizeof(ZELChunkRange))
+            return NULL;
+        size_t neededBytes = neededRanges * sizeof(ZELChunkRange);
+        ZELChunkRange *newBuf = (ZELChunkRange *)realloc(scratch->chunkRanges, neededBytes);
+        if (!newBuf)
+            return NULL;
+        scratch->chunkRanges = newBuf;
+        scratch->chunkRangeCapacity = neededRanges;
+    }
+
+    return scratch->chunkRanges;
+}
+
+ZELStreamRange *zelAcquireReadRangeScratch(ZELScratch *scratch, size_t neededRanges) {
+    if (!scratch || neededRanges == 0)
+        return NULL;
+
+    if (scratch->readRangeCapacity < neededRanges) {
+        if (neededRanges > SIZE_MAX / sizeof(ZELStreamRange))
+            return NULL;
+        size_t neededBytes = neededRanges * sizeof(ZELStreamRange);
+        ZELStreamRange *newBuf = (ZELStreamRange *)realloc(scratch->readRanges, neededBytes);
+        if (!newBuf)
+            return NULL;
+        scratch->readRanges = newBuf;
+        scratch->readRangeCapacity = neededRanges;
+    }
+
+    return scratch->readRanges;
+}
+
+void zelReleaseScratch(ZELScratch *scratch) {
+    if (!scratch)
+        return;
+
+    if (scratch->zone)
+        free(scratch->zone);
+
+    if (scratch->frameData)
+        free(scratch->frameData);
+
+    if (scratch->palette)
+        free(scratch->palette);
+
+    if (scratch->zoneRgb)
+        free(scratch->zoneRgb);
+
+    if (scratch->blend)
+        free(scratch->blend);
+
+    if (scratch->packed)
+        free(scratch->packed);
+
+    if (scratch->gray)
+        free(scratch->gray);
+
+    if (scratch->chunkRanges)
+        free(scratch->chunkRanges);
+
+    if (scratch->readRanges)
+        free(scratch->readRanges);
+
+    memset(scratch, 0, sizeof(*scratch));
+}
+
+static void zelComputeZoneLayout(const ZELFileHeader *h, ZELZoneLayout *outLayout) {
+    outLayout->zoneWidth = h->zoneWidth;
+    outLayout->zoneHeight = h->zoneHeight;
+    outLayout->zonesPerRow = h->width / h->zoneWidth;
+    outLayout->zonesPerCol = h->height / h->zoneHeight;
+    outLayout->zoneCount = outLayout->zonesPerRow * outLayout->zonesPerCol;
+    outLayout->zonePixelBytes = (size_t)h->zoneWidth * (size_t)h->zoneHeight;
 }
 
 static ZELResult zelInitializeContext(ZELContext *ctx) {
@@ -140,6 +300,8 @@ static ZELResult zelInitializeContext(ZELContext *ctx) {
         return ZEL_ERR_CORRUPT_DATA;
 
     memcpy(&ctx->header, &tmpHeader, sizeof(ZELFileHeader));
+    zelComputeZoneLayout(&ctx->header, &ctx->layout);
+    ctx->blit = zelSelectBlitKernels(ctx->layout.zoneWidth, ctx->layout.zoneHeight);
 
     size_t offset = ctx->header.headerSize;
 
@@ -298,10 +460,90 @@ fail:
     return NULL;
 }
 
+ZELContext *zelOpenStreamPreload(const ZELInputStream *stream,
+                                 const ZELPreloadOptions *options,
+                                 ZELResult *outResult) {
+    ZELResult result = ZEL_OK;
+    ZELContext *ctx = NULL;
+
+    if (!options || options->mode > ZEL_PRELOAD_BELOW_SIZE) {
+        result = ZEL_ERR_INVALID_ARGUMENT;
+        goto fail;
+    }
+
+    ctx = zelOpenStream(stream, &result);
+    if (!ctx)
+        goto fail;
+
+    int wanted = options->mode == ZEL_PRELOAD_ALWAYS
+                 || (options->mode == ZEL_PRELOAD_BELOW_SIZE && ctx->size <= options->maxBytes);
+    if (wanted) {
+        ctx->preload = (uint8_t *)malloc(ctx->size);
+        if (!ctx->preload && options->mode == ZEL_PRELOAD_ALWAYS) {
+            result = ZEL_ERR_OUT_OF_MEMORY;
+            goto fail;
+        }
+        ctx->preloadChunkBytes = options->chunkBytes ? options->chunkBytes
+                                                     : ZEL_PRELOAD_DEFAULT_CHUNK;
+    }
+
+    if (ctx->preload && !options->deferred) {
+        size_t remaining = 0;
+        do {
+            result = zelPreloadStep(ctx, &remaining);
+            if (result != ZEL_OK)
+                goto fail;
+        } while (remaining > 0);
+    }
+
+    if (outResult)
+        *outResult = ZEL_OK;
+    return ctx;
+
+fail:
+    if (ctx)
+        zelClose(ctx);
+    if (outResult)
+        *outResult = result;
+    return NULL;
+}
+
+ZELResult zelPreloadStep(ZELContext *ctx, size_t *outRemaining) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELResult result = ZEL_OK;
+    if (ctx->preload && !ctx->data) {
+        size_t length = ctx->size - ctx->preloadedBytes;
+        if (length > ctx->preloadChunkBytes)
+            length = ctx->preloadChunkBytes;
+
+        size_t bytesRead = ctx->stream.read(ctx->stream.userData,
+                                            ctx->preloadedBytes,
+                                            ctx->preload + ctx->preloadedBytes,
+                                            length);
+        if (bytesRead == length) {
+            ctx->preloadedBytes += length;
+            /* From here on every path takes the memory branch and never touches the stream. */
+            if (ctx->preloadedBytes == ctx->size)
+                ctx->data = ctx->preload;
+        } else {
+            result = ZEL_ERR_IO;
+        }
+    }
+
+    if (outRemaining)
+        *outRemaining = ctx->preload && !ctx->data ? ctx->size - ctx->preloadedBytes : 0;
+    return result;
+}
+
 void zelClose(ZELContext *ctx) {
     if (!ctx)
         return;
 
+    /* Queued reads target the stream's descriptor, so they are drained before it closes. */
+    zelDestroyUringPrefetch(ctx->prefetch);
+
     if (ctx->stream.close)
         ctx->stream.close(ctx->stream.userData);
 
@@ -311,18 +553,14 @@ void zelClose(ZELContext *ctx) {
     if (ctx->globalPaletteOwned)
         free(ctx->globalPaletteOwned);
 
-    if (ctx->zoneScratch)
-        free(ctx->zoneScratch);
-
-    if (ctx->frameDataScratch)
-        free(ctx->frameDataScratch);
-
-    if (ctx->paletteScratch)
-        free(ctx->paletteScratch);
+    zelReleaseScratch(&ctx->scratch);
 
     if (ctx->frameIndexOwned)
         free(ctx->frameIndexOwned);
 
+    if (ctx->preload)
+        free(ctx->preload);
+
     free(ctx);
 }
 
@@ -358,7 +596,7 @@ void zelSetOutputColorEncoding(ZELContext *ctx, ZELColorEncoding encoding) {
     if (!ctx)
         return;
 
-    if (!zelIsValidColorEncoding((uint8_t)encoding))
+    if (!zelIsValidOutputEncoding((uint8_t)encoding))
         return;
 
     if (!ctx->hasCustomOutputEncoding || ctx->outputColorEncoding != encoding) {
@@ -372,10 +610,53 @@ ZELColorEncoding zelGetOutputColorEncoding(const ZELContext *ctx) {
     if (!ctx)
         return ZEL_COLOR_RGB565_LE;
 
-    if (ctx->hasCustomOutputEncoding)
-        return ctx->outputColorEncoding;
+    return zelSelectOutputEncoding(ctx, ctx->globalPaletteEncoding);
+}
+
+ZELResult zelSetTrustedMode(ZELContext *ctx, int enabled) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
 
-    return ctx->globalPaletteEncoding;
+    if (enabled && !ctx->validated)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ctx->trusted = enabled ? 1 : 0;
+    return ZEL_OK;
+}
+
+int zelIsTrustedMode(const ZELContext *ctx) {
+    return ctx ? ctx->trusted : 0;
+}
+
+ZELResult zelSetStreamReadMode(ZELContext *ctx, ZELStreamReadMode mode) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (mode != ZEL_STREAM_READ_FRAME && mode != ZEL_STREAM_READ_ZONE)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* Memory contexts never copy frame data, so there is nothing to choose. */
+    if (ctx->data)
+        return ZEL_OK;
+
+    ctx->streamReadMode = mode;
+    return ZEL_OK;
+}
+
+ZELResult zelSetStreamHint(ZELContext *ctx, ZELStreamHintFunc hint) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ctx->streamHint = hint;
+    return ZEL_OK;
+}
+
+ZELResult zelSetStreamReadv(ZELContext *ctx, ZELStreamReadvFunc readv) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ctx->streamReadv = readv;
+    return ZEL_OK;
 }
 
 int zelHasGlobalPalette(const ZELContext *ctx) {
@@ -0,0 +1,242 @@
+/* O_DIRECT and pread need more than strict C11 exposes; the amalgamation defines this too. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "zel_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ZEL_HAVE_POSIX_FILES 1
+#endif
+
+#ifdef ZEL_HAVE_POSIX_FILES
+
+/* Block size O_DIRECT offsets, lengths and buffers are rounded to. 4096 satisfies the logical
+   block size of common disks and flash. */
+#define ZEL_DIRECT_ALIGNMENT 4096u
+
+static size_t zelStdioStreamRead(void *userData, size_t offset, void *dst, size_t size) {
+    FILE *file = (FILE *)userData;
+    if ((uint64_t)offset > (uint64_t)INT64_MAX)
+        return 0;
+
+    /* The seek and read must not interleave with another thread's. */
+    flockfile(file);
+    size_t got = 0;
+    if (fseeko(file, (off_t)offset, SEEK_SET) == 0)
+        got = fread(dst, 1, size, file);
+    funlockfile(file);
+    return got == size ? size : 0;
+}
+
+/* Fills dst completely, retrying short and interrupted reads. Returns the bytes read, which is
+   less than size only at end of file or on error. */
+static size_t zelPreadFully(int fd, uint8_t *dst, size_t size, size_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = pread(fd, dst + done, size - done, (off_t)(offset + done));
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            break;
+        done += (size_t)got;
+    }
+    return done;
+}
+
+static size_t zelFdStreamRead(void *userData, size_t offset, void *dst, size_t size) {
+    int fd = (int)(intptr_t)userData;
+    return zelPreadFully(fd, (uint8_t *)dst, size, offset) == size ? size : 0;
+}
+
+/* O_DIRECT reads must start, end and land on block boundaries, so each read goes through an
+   aligned bounce buffer covering the request. Reads spanning at most two blocks, which covers
+   zone-read mode's size prefixes and most zone chunks, use a buffer on the stack; larger ones
+   allocate. Both are per call, which keeps the stream safe to share between workers. */
+static size_t zelDirectFdStreamRead(void *userData, size_t offset, void *dst, size_t size) {
+    int fd = (int)(intptr_t)userData;
+    size_t alignedOffset = offset & ~(size_t)(ZEL_DIRECT_ALIGNMENT - 1u);
+    size_t lead = offset - alignedOffset;
+    if (size > SIZE_MAX - lead - ZEL_DIRECT_ALIGNMENT)
+        return 0;
+    size_t alignedSize = (lead + size + ZEL_DIRECT_ALIGNMENT - 1u) &
+                         ~(size_t)(ZEL_DIRECT_ALIGNMENT - 1u);
+
+    _Alignas(ZEL_DIRECT_ALIGNMENT) uint8_t blocks[2u * ZEL_DIRECT_ALIGNMENT];
+    void *bounce = blocks;
+    if (alignedSize > sizeof(blocks) &&
+        posix_memalign(&bounce, ZEL_DIRECT_ALIGNMENT, alignedSize) != 0)
+        return 0;
+
+    /* The last block of the file comes back short; only the requested bytes must be there. */
+    size_t got = zelPreadFully(fd, (uint8_t *)bounce, alignedSize, alignedOffset);
+    size_t result = 0;
+    if (got >= lead + size) {
+        memcpy(dst, (const uint8_t *)bounce + lead, size);
+        result = size;
+    }
+    if (bounce != blocks)
+        free(bounce);
+    return result;
+}
+
+#ifdef POSIX_FADV_WILLNEED
+/* Starts page-cache readahead for the range so the coming pread finds it in memory. */
+static void zelFdStreamHint(void *userData, size_t offset, size_t size) {
+    if ((uint64_t)offset > (uint64_t)INT64_MAX || (uint64_t)size > (uint64_t)INT64_MAX)
+        return;
+    posix_fadvise((int)(intptr_t)userData, (off_t)offset, (off_t)size, POSIX_FADV_WILLNEED);
+}
+#endif
+
+static void zelCloseFdStream(void *userData) {
+    close((int)(intptr_t)userData);
+}
+
+static ZELResult zelFdSize(int fd, size_t *outSize) {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return ZEL_ERR_IO;
+    if (st.st_size < 0 || (uint64_t)st.st_size > (uint64_t)SIZE_MAX)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+    *outSize = (size_t)st.st_size;
+    return ZEL_OK;
+}
+
+int zelStreamDescriptor(const ZELInputStream *stream) {
+    if (stream->read == zelFdStreamRead || stream->read == zelDirectFdStreamRead)
+        return (int)(intptr_t)stream->userData;
+    return -1;
+}
+
+ZELResult zelInitStdioStream(FILE *file, ZELInputStream *outStream) {
+    if (!file || !outStream)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    flockfile(file);
+    off_t end = -1;
+    if (fseeko(file, 0, SEEK_END) == 0)
+        end = ftello(file);
+    funlockfile(file);
+    if (end < 0)
+        return ZEL_ERR_IO;
+    if ((uint64_t)end > (uint64_t)SIZE_MAX)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    memset(outStream, 0, sizeof(*outStream));
+    outStream->read = zelStdioStreamRead;
+    outStream->userData = file;
+    outStream->size = (size_t)end;
+    return ZEL_OK;
+}
+
+ZELResult zelInitFdStream(int fd, uint32_t flags, ZELInputStream *outStream) {
+    if (fd < 0 || !outStream || (flags & ~(uint32_t)ZEL_FILE_DIRECT))
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    size_t size = 0;
+    ZELResult result = zelFdSize(fd, &size);
+    if (result != ZEL_OK)
+        return result;
+
+    memset(outStream, 0, sizeof(*outStream));
+    outStream->read = (flags & ZEL_FILE_DIRECT) ? zelDirectFdStreamRead : zelFdStreamRead;
+    outStream->userData = (void *)(intptr_t)fd;
+    outStream->size = size;
+    return ZEL_OK;
+}
+
+ZELContext *zelOpenFile(const char *path, uint32_t flags, ZELResult *outResult) {
+    ZELResult result = ZEL_OK;
+    int fd = -1;
+
+    if (!path || (flags & ~(uint32_t)ZEL_FILE_DIRECT)) {
+        result = ZEL_ERR_INVALID_ARGUMENT;
+        goto fail;
+    }
+
+    int openFlags = O_RDONLY;
+#ifdef O_CLOEXEC
+    openFlags |= O_CLOEXEC;
+#endif
+#ifdef O_DIRECT
+    if (flags & ZEL_FILE_DIRECT)
+        openFlags |= O_DIRECT;
+#endif
+    fd = open(path, openFlags);
+    if (fd < 0) {
+        result = ZEL_ERR_IO;
+        goto fail;
+    }
+
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    /* macOS has no O_DIRECT; F_NOCACHE bypasses the page cache without alignment rules. */
+    if (flags & ZEL_FILE_DIRECT)
+        fcntl(fd, F_NOCACHE, 1);
+#endif
+
+    ZELInputStream stream;
+    result = zelInitFdStream(fd, flags, &stream);
+    if (result != ZEL_OK)
+        goto fail;
+
+    /* The context only takes over the descriptor once it opened, so every failure path
+       closes it here exactly once. */
+    ZELContext *ctx = zelOpenStream(&stream, &result);
+    if (!ctx)
+        goto fail;
+
+    ctx->stream.close = zelCloseFdStream;
+#ifdef POSIX_FADV_WILLNEED
+    /* Direct reads bypass the page cache, so readahead would only waste memory. */
+    if (!(flags & ZEL_FILE_DIRECT))
+        ctx->streamHint = zelFdStreamHint;
+#endif
+    if (outResult)
+        *outResult = ZEL_OK;
+    return ctx;
+
+fail:
+    if (fd >= 0)
+        close(fd);
+    if (outResult)
+        *outResult = result;
+    return NULL;
+}
+
+#else
+
+int zelStreamDescriptor(const ZELInputStream *stream) {
+    (void)stream;
+    return -1;
+}
+
+ZELResult zelInitStdioStream(FILE *file, ZELInputStream *outStream) {
+    (void)file;
+    (void)outStream;
+    return ZEL_ERR_UNSUPPORTED_FORMAT;
+}
+
+ZELResult zelInitFdStream(int fd, uint32_t flags, ZELInputStream *outStream) {
+    (void)fd;
+    (void)flags;
+    (void)outStream;
+    return ZEL_ERR_UNSUPPORTED_FORMAT;
+}
+
+ZELContext *zelOpenFile(const char *path, uint32_t flags, ZELResult *outResult) {
+    (void)path;
+    (void)flags;
+    if (outResult)
+        *outResult = ZEL_ERR_UNSUPPORTED_FORMAT;
+    return NULL;
+}
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef LZ4_STATIC_LINKING_ONLY
+#define LZ4_STATIC_LINKING_ONLY
+#endif
 #include "lz4/lz4.h"
 #include "zel_internal.h"
 
@@ -5,52 +8,87 @@
 #include <stdlib.h>
 #include <string.h>
 
-static void zelZoneIndexToCoordinates(const ZELZoneLayout *layout,
-                                      uint32_t zoneIndex,
-                                      uint32_t *outX,
-                                      uint32_t *outY) {
-    uint32_t zonesPerRow = layout->zonesPerRow;
-    *outX = (zoneIndex % zonesPerRow) * layout->zoneWidth;
-    *outY = (zoneIndex / zonesPerRow) * layout->zoneHeight;
+/* Once frames come in sequence on this scratch (N after N - 1, wrapping at the loop point),
+   hints the block of the frame after frameIndex to the stream. */
+static void zelHintNextFrame(const ZELContext *ctx, uint32_t frameIndex, ZELScratch *scratch) {
+    uint32_t previous = scratch->lastStreamFrame;
+    scratch->lastStreamFrame = frameIndex + 1u;
+
+    uint32_t frameCount = ctx->header.frameCount;
+    if (!ctx->streamHint || previous == 0 || frameCount < 2 || previous % frameCount != frameIndex)
+        return;
+
+    const ZELFrameIndexEntry *next = &ctx->frameIndexTable[(frameIndex + 1u) % frameCount];
+    if (next->frameSize != 0 && zelRangeFits(next->frameOffset, next->frameSize, ctx->size))
+        ctx->streamHint(ctx->stream.userData, next->frameOffset, next->frameSize);
 }
 
-static ZELResult zelComputeZoneLayout(const ZELContext *ctx, ZELZoneLayout *outLayout) {
-    if (!ctx || !outLayout)
-        return ZEL_ERR_INVALID_ARGUMENT;
+/* Brings a whole frame block of a stream context into memory. Decodes on the context's own
+   scratch take it from the prefetch queue when one is enabled; other scratch sets (pool
+   workers) read it through the stream. */
+static ZELResult zelLoadFrameBlock(const ZELContext *ctx,
+                                   uint32_t frameIndex,
+                                   ZELScratch *scratch,
+                                   const uint8_t **outBytes) {
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+    if (ctx->prefetch && scratch == zelContextScratch(ctx))
+        return zelPrefetchFrameBlock(ctx->prefetch, frameIndex, outBytes);
 
-    if (ctx->header.zoneWidth == 0 || ctx->header.zoneHeight == 0)
-        return ZEL_ERR_CORRUPT_DATA;
+    uint8_t *frameScratch = zelAcquireFrameDataScratch(scratch, fi->frameSize);
+    if (!frameScratch)
+        return ZEL_ERR_OUT_OF_MEMORY;
 
-    if ((ctx->header.width % ctx->header.zoneWidth) != 0
-        || (ctx->header.height % ctx->header.zoneHeight) != 0) {
-        return ZEL_ERR_CORRUPT_DATA;
-    }
+    ZELResult result = zelReadAt(ctx, fi->frameOffset, frameScratch, fi->frameSize);
+    if (result != ZEL_OK)
+        return result;
 
-    uint32_t zonesPerRow = ctx->header.width / ctx->header.zoneWidth;
-    uint32_t zonesPerCol = ctx->header.height / ctx->header.zoneHeight;
-    uint32_t zoneCount = zonesPerRow * zonesPerCol;
+    zelHintNextFrame(ctx, frameIndex, scratch);
+    *outBytes = frameScratch;
+    return ZEL_OK;
+}
 
-    if (zonesPerRow == 0 || zonesPerCol == 0 || zoneCount == 0)
-        return ZEL_ERR_CORRUPT_DATA;
+static ZELResult zelInitFrameZoneStreamTrusted(const ZELContext *ctx,
+                                               uint32_t frameIndex,
+                                               ZELScratch *scratch,
+                                               ZELFrameZoneStream *outStream) {
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+    size_t frameOffset = fi->frameOffset;
+    size_t frameSize = fi->frameSize;
 
-    if (zoneCount > UINT16_MAX)
-        return ZEL_ERR_UNSUPPORTED_FORMAT;
+    const uint8_t *frameBytes = NULL;
+    if (ctx->data) {
+        frameBytes = ctx->data + frameOffset;
+    } else {
+        ZELResult result = zelLoadFrameBlock(ctx, frameIndex, scratch, &frameBytes);
+        if (result != ZEL_OK)
+            return result;
+    }
 
-    size_t zonePixelBytes = (size_t)ctx->header.zoneWidth * (size_t)ctx->header.zoneHeight;
-    if (zonePixelBytes == 0)
-        return ZEL_ERR_CORRUPT_DATA;
+    ZELFrameHeader fh;
+    zelParseFrameHeader(frameBytes, &fh);
 
-    outLayout->zoneWidth = ctx->header.zoneWidth;
-    outLayout->zoneHeight = ctx->header.zoneHeight;
-    outLayout->zonesPerRow = zonesPerRow;
-    outLayout->zonesPerCol = zonesPerCol;
-    outLayout->zoneCount = zoneCount;
-    outLayout->zonePixelBytes = zonePixelBytes;
+    size_t relOffset = fh.headerSize;
+    if (fh.flags.hasLocalPalette) {
+        ZELPaletteHeader ph;
+        zelParsePaletteHeader(frameBytes + relOffset, &ph);
+        relOffset += ph.headerSize + (size_t)ph.entryCount * sizeof(uint16_t);
+    }
+
+    outStream->header = fh;
+    outStream->frameOffset = frameOffset;
+    outStream->frameSize = frameSize;
+    outStream->zoneDataOffset = frameOffset + relOffset;
+    outStream->frameDataEnd = frameOffset + frameSize;
+    outStream->layout = ctx->layout;
+    outStream->frameData = frameBytes;
+    outStream->chunkBuffer = NULL;
+    outStream->chunkBufferSize = 0;
     return ZEL_OK;
 }
 
 static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
                                         uint32_t frameIndex,
+                                        ZELScratch *scratch,
                                         ZELFrameZoneStream *outStream) {
     if (!ctx || !outStream)
         return ZEL_ERR_INVALID_ARGUMENT;
@@ -58,6 +96,10 @@ static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
     if (frameIndex >= ctx->header.frameCount)
         return ZEL_ERR_OUT_OF_BOUNDS;
 
+    int zoneReads = !ctx->data && ctx->streamReadMode == ZEL_STREAM_READ_ZONE;
+    if (ctx->trusted && !zoneReads)
+        return zelInitFrameZoneStreamTrusted(ctx, frameIndex, scratch, outStream);
+
     const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
     size_t frameOffset = fi->frameOffset;
     size_t frameSize = fi->frameSize;
@@ -70,24 +112,27 @@ static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
         return ZEL_ERR_CORRUPT_DATA;
     }
 
+    /* In zone-read mode only the frame and palette headers are read here; zone chunks are
+       fetched one at a time by zelReadZoneChunkAtCursor. */
+    uint8_t headerBytes[ZEL_FRAME_HEADER_DISK_SIZE];
+    uint8_t paletteHeaderBytes[ZEL_PALETTE_HEADER_DISK_SIZE];
     const uint8_t *frameBytes = NULL;
     if (ctx->data) {
         frameBytes = ctx->data + frameOffset;
-    } else {
-        ZELContext *mutableCtx = (ZELContext *)ctx;
-        if (mutableCtx->frameDataScratchCapacity < frameSize) {
-            uint8_t *newBuf = (uint8_t *)realloc(mutableCtx->frameDataScratch, frameSize);
-            if (!newBuf)
-                return ZEL_ERR_OUT_OF_MEMORY;
-            mutableCtx->frameDataScratch = newBuf;
-            mutableCtx->frameDataScratchCapacity = frameSize;
-        }
+    } else if (zoneReads) {
+        if (frameSize < ZEL_FRAME_HEADER_DISK_SIZE)
+            return ZEL_ERR_CORRUPT_DATA;
 
-        ZELResult result = zelReadAt(ctx, frameOffset, mutableCtx->frameDataScratch, frameSize);
+        ZELResult result = zelReadAt(ctx, frameOffset, headerBytes, sizeof(headerBytes));
         if (result != ZEL_OK)
             return result;
 
-        frameBytes = mutableCtx->frameDataScratch;
+        zelHintNextFrame(ctx, frameIndex, scratch);
+        frameBytes = headerBytes;
+    } else {
+        ZELResult result = zelLoadFrameBlock(ctx, frameIndex, scratch, &frameBytes);
+        if (result != ZEL_OK)
+            return result;
     }
 
     if (frameSize < ZEL_FRAME_HEADER_DISK_SIZE)
@@ -105,8 +150,19 @@ static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
         if (frameSize - relOffset < ZEL_PALETTE_HEADER_DISK_SIZE)
             return ZEL_ERR_CORRUPT_DATA;
 
+        const uint8_t *paletteHeader = frameBytes + relOffset;
+        if (zoneReads) {
+            ZELResult result = zelReadAt(ctx,
+                                         frameOffset + relOffset,
+                                         paletteHeaderBytes,
+                                         sizeof(paletteHeaderBytes));
+            if (result != ZEL_OK)
+                return result;
+            paletteHeader = paletteHeaderBytes;
+        }
+
         ZELPaletteHeader ph;
-        zelParsePaletteHeader(frameBytes + relOffset, &ph);
+        zelParsePaletteHeader(paletteHeader, &ph);
         if (ph.headerSize < ZEL_PALETTE_HEADER_DISK_SIZE || ph.entryCount == 0)
             return ZEL_ERR_CORRUPT_DATA;
 
@@ -128,12 +184,8 @@ static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
     size_t frameEnd = frameOffset + frameSize;
     size_t offset = frameOffset + relOffset;
 
-    ZELZoneLayout layout;
-    ZELResult zr = zelComputeZoneLayout(ctx, &layout);
-    if (zr != ZEL_OK)
-        return zr;
-
-    if (layout.zoneCount == 0 || fh.zoneCount != (uint16_t)layout.zoneCount)
+    const ZELZoneLayout *layout = &ctx->layout;
+    if (layout->zoneCount == 0 || fh.zoneCount != (uint16_t)layout->zoneCount)
         return ZEL_ERR_CORRUPT_DATA;
 
     outStream->header = fh;
@@ -141,11 +193,93 @@ static ZELResult zelInitFrameZoneStream(const ZELContext *ctx,
     outStream->frameSize = frameSize;
     outStream->zoneDataOffset = offset;
     outStream->frameDataEnd = frameEnd;
-    outStream->layout = layout;
-    outStream->frameData = frameBytes;
+    outStream->layout = *layout;
+    outStream->frameData = zoneReads ? NULL : frameBytes;
+    outStream->chunkBuffer = NULL;
+    outStream->chunkBufferSize = 0;
+
+    if (zoneReads) {
+        /* One buffer serves as both the read target and the decompressed zone: LZ4 chunks are
+           read into its tail and decoded in place, which needs LZ4's documented margin. */
+        size_t bufferSize = layout->zonePixelBytes;
+        if (fh.compressionType == ZEL_COMPRESSION_LZ4) {
+            if (bufferSize > (size_t)INT32_MAX / 2)
+                return ZEL_ERR_UNSUPPORTED_FORMAT;
+            /* Sized for the largest chunk LZ4 can emit, so incompressible zones fit too. */
+            size_t boundSize = (size_t)LZ4_COMPRESSBOUND((int)bufferSize);
+            size_t inPlaceSize = bufferSize + LZ4_DECOMPRESS_INPLACE_MARGIN(boundSize);
+            bufferSize = inPlaceSize > boundSize ? inPlaceSize : boundSize;
+        }
+
+        outStream->chunkBuffer = zelAcquireZoneScratch(scratch, bufferSize);
+        if (!outStream->chunkBuffer)
+            return ZEL_ERR_OUT_OF_MEMORY;
+        outStream->chunkBufferSize = bufferSize;
+    }
+
     return ZEL_OK;
 }
 
+/* Zone-read mode: reads a chunk whose size prefix was already checked into the end of the
+   stream's chunk buffer, where LZ4 can decode it in place. */
+static ZELResult zelLoadZoneChunk(const ZELContext *ctx,
+                                  const ZELFrameZoneStream *stream,
+                                  size_t chunkOffset,
+                                  uint32_t chunkSize,
+                                  const uint8_t **outData) {
+    uint8_t *chunkData = stream->chunkBuffer + (stream->chunkBufferSize - chunkSize);
+    if (stream->header.compressionType != ZEL_COMPRESSION_LZ4)
+        chunkData = stream->chunkBuffer;
+
+    ZELResult result = zelReadAt(ctx, chunkOffset, chunkData, chunkSize);
+    if (result != ZEL_OK)
+        return result;
+
+    *outData = chunkData;
+    return ZEL_OK;
+}
+
+/* Zone-read mode: reads the size prefix at the cursor and, if loadData is set, the chunk
+   itself into the end of the stream's chunk buffer. */
+static ZELResult zelReadZoneChunkFromStream(const ZELContext *ctx,
+                                            const ZELFrameZoneStream *stream,
+                                            size_t *cursor,
+                                            int loadData,
+                                            const uint8_t **outData,
+                                            uint32_t *outSize) {
+    if (*cursor < stream->frameOffset || *cursor > stream->frameDataEnd)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    if (stream->frameDataEnd - *cursor < sizeof(uint32_t))
+        return ZEL_ERR_CORRUPT_DATA;
+
+    uint8_t sizeBytes[sizeof(uint32_t)];
+    ZELResult result = zelReadAt(ctx, *cursor, sizeBytes, sizeof(sizeBytes));
+    if (result != ZEL_OK)
+        return result;
+
+    uint32_t chunkSize = zelLe32(sizeBytes);
+    size_t chunkOffset = *cursor + sizeof(uint32_t);
+    if (chunkSize == 0 || (size_t)chunkSize > stream->frameDataEnd - chunkOffset)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    if ((size_t)chunkSize > stream->chunkBufferSize)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    if (stream->header.compressionType == ZEL_COMPRESSION_LZ4
+        && stream->layout.zonePixelBytes + LZ4_DECOMPRESS_INPLACE_MARGIN((size_t)chunkSize)
+                   > stream->chunkBufferSize)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    *cursor = chunkOffset + chunkSize;
+    *outSize = chunkSize;
+    *outData = NULL;
+    if (!loadData)
+        return ZEL_OK;
+
+    return zelLoadZoneChunk(ctx, stream, chunkOffset, chunkSize, outData);
+}
+
 static ZELResult zelReadZoneChunkAtCursor(const ZELContext *ctx,
                                           const ZELFrameZoneStream *stream,
                                           size_t *cursor,
@@ -154,8 +288,19 @@ static ZELResult zelReadZoneChunkAtCursor(const ZELContext *ctx,
     if (!ctx || !stream || !cursor || !outData || !outSize)
         return ZEL_ERR_INVALID_ARGUMENT;
 
-    if (!stream->frameData)
-        return ZEL_ERR_INTERNAL;
+    if (!stream->frameData) {
+        if (!stream->chunkBuffer)
+            return ZEL_ERR_INTERNAL;
+        return zelReadZoneChunkFromStream(ctx, stream, cursor, 1, outData, outSize);
+    }
+
+    if (ctx->trusted) {
+        const uint8_t *chunk = stream->frameData + (*cursor - stream->frameOffset);
+        *outSize = zelLe32(chunk);
+        *outData = chunk + sizeof(uint32_t);
+        *cursor += sizeof(uint32_t) + *outSize;
+        return ZEL_OK;
+    }
 
     if (*cursor < stream->frameOffset || *cursor > stream->frameDataEnd)
         return ZEL_ERR_CORRUPT_DATA;
@@ -196,7 +341,10 @@ static ZELResult zelLocateZoneChunk(const ZELContext *ctx,
     uint32_t chunkSize = 0;
 
     for (uint32_t idx = 0; idx <= targetZone; ++idx) {
-        result = zelReadZoneChunkAtCursor(ctx, stream, &cursor, &chunkData, &chunkSize);
+        if (!stream->frameData && idx < targetZone)
+            result = zelReadZoneChunkFromStream(ctx, stream, &cursor, 0, &chunkData, &chunkSize);
+        else
+            result = zelReadZoneChunkAtCursor(ctx, stream, &cursor, &chunkData, &chunkSize);
         if (result != ZEL_OK)
             return result;
     }
@@ -212,9 +360,23 @@ static ZELResult zelAccessZonePixels(const ZELContext *ctx,
                                      uint32_t chunkSize,
                                      uint8_t *scratch,
                                      const uint8_t **outPixels) {
-    (void)ctx;
     size_t zoneBytes = stream->layout.zonePixelBytes;
 
+    if (ctx->trusted) {
+        if (stream->header.compressionType == ZEL_COMPRESSION_NONE) {
+            *outPixels = chunkData;
+            return ZEL_OK;
+        }
+        int decodedBytes = LZ4_decompress_safe((const char *)chunkData,
+                                               (char *)scratch,
+                                               (int)chunkSize,
+                                               (int)zoneBytes);
+        if (decodedBytes < 0)
+            return ZEL_ERR_CORRUPT_DATA;
+        *outPixels = scratch;
+        return ZEL_OK;
+    }
+
     switch (stream->header.compressionType) {
         case ZEL_COMPRESSION_NONE:
             if ((size_t)chunkSize != zoneBytes)
@@ -243,45 +405,57 @@ static ZELResult zelAccessZonePixels(const ZELContext *ctx,
     }
 }
 
-static void zelBlitZoneIndices(const ZELZoneLayout *layout,
-                               uint32_t zoneIndex,
-                               const uint8_t *zonePixels,
-                               uint8_t *dst,
-                               size_t dstStrideBytes) {
-    uint32_t zoneX = 0;
-    uint32_t zoneY = 0;
-    zelZoneIndexToCoordinates(layout, zoneIndex, &zoneX, &zoneY);
-
-    for (uint32_t row = 0; row < layout->zoneHeight; ++row) {
-        uint8_t *dstRow = dst + (size_t)(zoneY + row) * dstStrideBytes + zoneX;
-        const uint8_t *srcRow = zonePixels + (size_t)row * layout->zoneWidth;
-        memcpy(dstRow, srcRow, layout->zoneWidth);
-    }
-}
-
-static ZELResult zelBlitZoneRgb(const ZELZoneLayout *layout,
-                                uint32_t zoneIndex,
-                                const uint8_t *zonePixels,
-                                const uint16_t *palette,
-                                uint16_t paletteCount,
-                                uint16_t *dst,
-                                size_t dstStridePixels) {
-    uint32_t zoneX = 0;
-    uint32_t zoneY = 0;
-    zelZoneIndexToCoordinates(layout, zoneIndex, &zoneX, &zoneY);
-
-    for (uint32_t row = 0; row < layout->zoneHeight; ++row) {
-        uint16_t *dstRow = dst + (size_t)(zoneY + row) * dstStridePixels + zoneX;
-        const uint8_t *srcRow = zonePixels + (size_t)row * layout->zoneWidth;
-
-        for (uint32_t col = 0; col < layout->zoneWidth; ++col) {
-            uint8_t idx = srcRow[col];
-            if (idx >= paletteCount)
-                return ZEL_ERR_CORRUPT_DATA;
-            dstRow[col] = palette[idx];
-        }
+ZELResult zelValidateFrameWithScratch(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      ZELScratch *scratchSet,
+                                      uint32_t *outZoneIndex) {
+    if (!ctx || !scratchSet || !outZoneIndex)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    *outZoneIndex = ZEL_INDEX_NONE;
+
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    ZELFrameZoneStream stream;
+    result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
+    if (result != ZEL_OK)
+        return result;
+
+    uint8_t *scratch = NULL;
+    if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
+        if (!scratch)
+            return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    size_t cursor = stream.zoneDataOffset;
+    for (uint32_t zoneIndex = 0; zoneIndex < stream.layout.zoneCount; ++zoneIndex) {
+        *outZoneIndex = zoneIndex;
+
+        const uint8_t *chunkData = NULL;
+        uint32_t chunkSize = 0;
+        result = zelReadZoneChunkAtCursor(ctx, &stream, &cursor, &chunkData, &chunkSize);
+        if (result != ZEL_OK)
+            return result;
+
+        const uint8_t *zonePixels = NULL;
+        result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, scratch, &zonePixels);
+        if (result != ZEL_OK)
+            return result;
+
+        if (zelMaxIndex8(zonePixels, stream.layout.zonePixelBytes) >= paletteCount)
+            return ZEL_ERR_CORRUPT_DATA;
     }
 
+    *outZoneIndex = ZEL_INDEX_NONE;
+    if (cursor != stream.frameDataEnd)
+        return ZEL_ERR_CORRUPT_DATA;
+
     return ZEL_OK;
 }
 
@@ -350,18 +524,20 @@ ZELResult zelDecodeFrameIndex8(const ZELContext *ctx,
     if (dstStrideBytes < width)
         return ZEL_ERR_INVALID_ARGUMENT;
 
+    ZELScratch *scratchSet = zelContextScratch(ctx);
     ZELFrameZoneStream stream;
-    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, &stream);
+    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
     if (result != ZEL_OK)
         return result;
 
     uint8_t *scratch = NULL;
     if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
-        scratch = zelAcquireZoneScratch(ctx, stream.layout.zonePixelBytes);
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
         if (!scratch)
             return ZEL_ERR_OUT_OF_MEMORY;
     }
 
+    const ZELBlitKernels *blit = ctx->blit;
     size_t cursor = stream.zoneDataOffset;
     for (uint32_t zoneIndex = 0; zoneIndex < stream.layout.zoneCount; ++zoneIndex) {
         const uint8_t *chunkData = NULL;
@@ -375,7 +551,7 @@ ZELResult zelDecodeFrameIndex8(const ZELContext *ctx,
         if (result != ZEL_OK)
             break;
 
-        zelBlitZoneIndices(&stream.layout, zoneIndex, zonePixels, dst, dstStrideBytes);
+        blit->indices(&stream.layout, zoneIndex, zonePixels, dst, dstStrideBytes);
     }
 
     if (result == ZEL_OK && cursor != stream.frameDataEnd)
@@ -394,8 +570,9 @@ ZELResult zelDecodeFrameIndex8Zone(const ZELContext *ctx,
     if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
         return ZEL_ERR_UNSUPPORTED_FORMAT;
 
+    ZELScratch *scratchSet = zelContextScratch(ctx);
     ZELFrameZoneStream stream;
-    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, &stream);
+    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
     if (result != ZEL_OK)
         return result;
 
@@ -404,11 +581,12 @@ ZELResult zelDecodeFrameIndex8Zone(const ZELContext *ctx,
 
     uint8_t *scratch = NULL;
     if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
-        scratch = zelAcquireZoneScratch(ctx, stream.layout.zonePixelBytes);
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
         if (!scratch)
             return ZEL_ERR_OUT_OF_MEMORY;
     }
 
+    const ZELBlitKernels *blit = ctx->blit;
     const uint8_t *chunkData = NULL;
     uint32_t chunkSize = 0;
     result = zelLocateZoneChunk(ctx, &stream, zoneIndex, &chunkData, &chunkSize);
@@ -416,44 +594,177 @@ ZELResult zelDecodeFrameIndex8Zone(const ZELContext *ctx,
         const uint8_t *zonePixels = NULL;
         result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, scratch, &zonePixels);
         if (result == ZEL_OK)
-            zelBlitZoneIndices(&stream.layout, 0, zonePixels, dst, stream.layout.zoneWidth);
+            blit->indices(&stream.layout, 0, zonePixels, dst, stream.layout.zoneWidth);
     }
 
     return result;
 }
 
-ZELResult zelDecodeFrameRgb565(const ZELContext *ctx,
-                               uint32_t frameIndex,
-                               uint16_t *dst,
-                               size_t dstStridePixels) {
-    if (!ctx || !dst)
+static int zelClipRegion(const ZELContext *ctx, const ZELRect *region, ZELRect *outRect) {
+    if (!region) {
+        outRect->x = 0;
+        outRect->y = 0;
+        outRect->width = ctx->header.width;
+        outRect->height = ctx->header.height;
+        return 1;
+    }
+
+    if (region->x > ctx->header.width || region->y > ctx->header.height)
+        return 0;
+    if (region->width > ctx->header.width - region->x
+        || region->height > ctx->header.height - region->y)
+        return 0;
+
+    *outRect = *region;
+    return 1;
+}
+
+ZELResult zelBuildFrameIndex8Copies(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    const ZELRect *region,
+                                    uint8_t *dst,
+                                    size_t dstStrideBytes,
+                                    ZELCopyDescriptor *descriptors,
+                                    size_t descriptorCapacity,
+                                    size_t *outCount) {
+    if (!ctx || !dst || !outCount || (!descriptors && descriptorCapacity > 0))
         return ZEL_ERR_INVALID_ARGUMENT;
 
+    *outCount = 0;
+
     if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
         return ZEL_ERR_UNSUPPORTED_FORMAT;
 
-    uint16_t width = ctx->header.width;
+    if (dstStrideBytes < ctx->header.width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELRect rect;
+    if (!zelClipRegion(ctx, region, &rect))
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    /* Descriptors point straight into the file, so only raw frames in memory qualify. */
+    if (!ctx->data)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    ZELFrameZoneStream stream;
+    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, zelContextScratch(ctx), &stream);
+    if (result != ZEL_OK)
+        return result;
+
+    if (stream.header.compressionType != ZEL_COMPRESSION_NONE)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    const ZELZoneLayout *layout = &stream.layout;
+    size_t count = 0;
+    const uint8_t *runSrcEnd = NULL;
+    const uint8_t *runDstEnd = NULL;
+    size_t cursor = stream.zoneDataOffset;
+    for (uint32_t zoneIndex = 0; zoneIndex < layout->zoneCount; ++zoneIndex) {
+        const uint8_t *chunkData = NULL;
+        uint32_t chunkSize = 0;
+        result = zelReadZoneChunkAtCursor(ctx, &stream, &cursor, &chunkData, &chunkSize);
+        if (result != ZEL_OK)
+            return result;
+
+        const uint8_t *zonePixels = NULL;
+        result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, NULL, &zonePixels);
+        if (result != ZEL_OK)
+            return result;
+
+        uint32_t zoneX = (zoneIndex % layout->zonesPerRow) * layout->zoneWidth;
+        uint32_t zoneY = (zoneIndex / layout->zonesPerRow) * layout->zoneHeight;
+        uint32_t left = zoneX > rect.x ? zoneX : rect.x;
+        uint32_t top = zoneY > rect.y ? zoneY : rect.y;
+        uint32_t right = zoneX + layout->zoneWidth;
+        uint32_t bottom = zoneY + layout->zoneHeight;
+        if (right > (uint32_t)rect.x + rect.width)
+            right = (uint32_t)rect.x + rect.width;
+        if (bottom > (uint32_t)rect.y + rect.height)
+            bottom = (uint32_t)rect.y + rect.height;
+        if (left >= right || top >= bottom)
+            continue;
+
+        size_t length = right - left;
+        for (uint32_t y = top; y < bottom; ++y) {
+            const uint8_t *src =
+                    zonePixels + (size_t)(y - zoneY) * layout->zoneWidth + (left - zoneX);
+            uint8_t *out = dst + (size_t)y * dstStrideBytes + left;
+
+            /* Rows that continue the previous copy on both sides extend it. */
+            if (count > 0 && src == runSrcEnd && out == runDstEnd) {
+                if (count <= descriptorCapacity)
+                    descriptors[count - 1].length += length;
+            } else {
+                if (count < descriptorCapacity) {
+                    descriptors[count].src = src;
+                    descriptors[count].dst = out;
+                    descriptors[count].length = length;
+                }
+                ++count;
+            }
+            runSrcEnd = src + length;
+            runDstEnd = out + length;
+        }
+    }
+
+    if (cursor != stream.frameDataEnd)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    *outCount = count;
+    return count > descriptorCapacity ? ZEL_ERR_OUT_OF_BOUNDS : ZEL_OK;
+}
+
+void zelExecuteCopies(const ZELCopyDescriptor *descriptors, size_t count) {
+    if (!descriptors)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+        memcpy(descriptors[i].dst, descriptors[i].src, descriptors[i].length);
+}
+
+ZELResult zelDecodeFrameRgb565OrientedWithScratch(const ZELContext *ctx,
+                                                  uint32_t frameIndex,
+                                                  ZELScratch *scratchSet,
+                                                  ZELOrientation orientation,
+                                                  uint16_t *dst,
+                                                  size_t dstStridePixels) {
+    if (!ctx || !scratchSet || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if ((unsigned)orientation & ~(unsigned)(ZEL_ORIENTATION_FLIP_X | ZEL_ORIENTATION_FLIP_Y |
+                                            ZEL_ORIENTATION_TRANSPOSE))
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    uint16_t width = (orientation & ZEL_ORIENTATION_TRANSPOSE) ? ctx->header.height
+                                                               : ctx->header.width;
     if (dstStridePixels < width)
         return ZEL_ERR_INVALID_ARGUMENT;
 
     const uint16_t *palette = NULL;
     uint16_t paletteCount = 0;
-    ZELResult result = zelGetFramePalette(ctx, frameIndex, &palette, &paletteCount);
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
     if (result != ZEL_OK)
         return result;
 
     ZELFrameZoneStream stream;
-    result = zelInitFrameZoneStream(ctx, frameIndex, &stream);
+    result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
     if (result != ZEL_OK)
         return result;
 
     uint8_t *scratch = NULL;
     if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
-        scratch = zelAcquireZoneScratch(ctx, stream.layout.zonePixelBytes);
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
         if (!scratch)
             return ZEL_ERR_OUT_OF_MEMORY;
     }
 
+    /* Trusted contexts passed zelValidate, so every index is known to fit its palette. */
+    int uncheckedIndices = ctx->trusted || paletteCount > UINT8_MAX;
+    const ZELBlitKernels *blit = ctx->blit;
     size_t cursor = stream.zoneDataOffset;
     for (uint32_t zoneIndex = 0; zoneIndex < stream.layout.zoneCount; ++zoneIndex) {
         const uint8_t *chunkData = NULL;
@@ -467,13 +778,39 @@ ZELResult zelDecodeFrameRgb565(const ZELContext *ctx,
         if (result != ZEL_OK)
             break;
 
-        result = zelBlitZoneRgb(&stream.layout,
-                                zoneIndex,
-                                zonePixels,
-                                palette,
-                                paletteCount,
-                                dst,
-                                dstStridePixels);
+        if (orientation != ZEL_ORIENTATION_IDENTITY) {
+            if (!uncheckedIndices &&
+                zelMaxIndex8(zonePixels, stream.layout.zonePixelBytes) >= paletteCount) {
+                result = ZEL_ERR_CORRUPT_DATA;
+                break;
+            }
+            zelBlitZoneRgbOriented(&stream.layout,
+                                   zoneIndex,
+                                   zonePixels,
+                                   palette,
+                                   orientation,
+                                   dst,
+                                   dstStridePixels);
+            continue;
+        }
+
+        if (uncheckedIndices) {
+            blit->rgbUnchecked(&stream.layout,
+                               zoneIndex,
+                               zonePixels,
+                               palette,
+                               dst,
+                               dstStridePixels);
+            continue;
+        }
+
+        result = blit->rgb(&stream.layout,
+                           zoneIndex,
+                           zonePixels,
+                           palette,
+                           paletteCount,
+                           dst,
+                           dstStridePixels);
         if (result != ZEL_OK)
             break;
     }
@@ -484,6 +821,132 @@ ZELResult zelDecodeFrameRgb565(const ZELContext *ctx,
     return result;
 }
 
+ZELResult zelDecodeFrameRgb565WithScratch(const ZELContext *ctx,
+                                          uint32_t frameIndex,
+                                          ZELScratch *scratchSet,
+                                          uint16_t *dst,
+                                          size_t dstStridePixels) {
+    return zelDecodeFrameRgb565OrientedWithScratch(ctx,
+                                                   frameIndex,
+                                                   scratchSet,
+                                                   ZEL_ORIENTATION_IDENTITY,
+                                                   dst,
+                                                   dstStridePixels);
+}
+
+ZELResult zelDecodeFrameRgb565(const ZELContext *ctx,
+                               uint32_t frameIndex,
+                               uint16_t *dst,
+                               size_t dstStridePixels) {
+    return zelDecodeFrameRgb565WithScratch(ctx,
+                                           frameIndex,
+                                           zelContextScratch(ctx),
+                                           dst,
+                                           dstStridePixels);
+}
+
+ZELResult zelDecodeFrameRgb565Oriented(const ZELContext *ctx,
+                                       uint32_t frameIndex,
+                                       ZELOrientation orientation,
+                                       uint16_t *dst,
+                                       size_t dstStridePixels) {
+    return zelDecodeFrameRgb565OrientedWithScratch(ctx,
+                                                   frameIndex,
+                                                   zelContextScratch(ctx),
+                                                   orientation,
+                                                   dst,
+                                                   dstStridePixels);
+}
+
+typedef struct {
+    const uint16_t *palette;
+    const ZELRect *visible;
+    uint16_t *dst;
+    size_t dstStridePixels;
+} ZELClippedTarget;
+
+static int zelClippedZoneVisible(void *userData, const ZELZoneLayout *layout, uint32_t zoneIndex) {
+    const ZELRect *rect = ((const ZELClippedTarget *)userData)->visible;
+    uint32_t zoneX = (zoneIndex % layout->zonesPerRow) * layout->zoneWidth;
+    uint32_t zoneY = (zoneIndex / layout->zonesPerRow) * layout->zoneHeight;
+    return zoneX < (uint32_t)rect->x + rect->width && rect->x < zoneX + layout->zoneWidth &&
+           zoneY < (uint32_t)rect->y + rect->height && rect->y < zoneY + layout->zoneHeight;
+}
+
+static ZELResult zelVisitClippedZone(void *userData,
+                                     const ZELZoneLayout *layout,
+                                     uint32_t zoneIndex,
+                                     const uint8_t *zonePixels) {
+    const ZELClippedTarget *target = (const ZELClippedTarget *)userData;
+    zelBlitZoneRgbClipped(layout,
+                          zoneIndex,
+                          zonePixels,
+                          target->palette,
+                          target->visible,
+                          target->dst,
+                          target->dstStridePixels);
+    return ZEL_OK;
+}
+
+ZELResult zelDecodeFrameRgb565At(const ZELContext *ctx,
+                                 uint32_t frameIndex,
+                                 int32_t originX,
+                                 int32_t originY,
+                                 const ZELRect *clip,
+                                 uint16_t *canvas,
+                                 size_t canvasStridePixels) {
+    if (!ctx || !clip || !canvas)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (canvasStridePixels < (size_t)clip->x + clip->width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (frameIndex >= ctx->header.frameCount)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    /* Intersect the clip with the placed frame, working in frame coordinates. */
+    int64_t left = (int64_t)clip->x - originX;
+    int64_t top = (int64_t)clip->y - originY;
+    int64_t right = left + clip->width;
+    int64_t bottom = top + clip->height;
+    if (left < 0)
+        left = 0;
+    if (top < 0)
+        top = 0;
+    if (right > ctx->header.width)
+        right = ctx->header.width;
+    if (bottom > ctx->header.height)
+        bottom = ctx->header.height;
+    if (left >= right || top >= bottom)
+        return ZEL_OK;
+
+    ZELRect visible = {(uint16_t)left, (uint16_t)top, (uint16_t)(right - left),
+                       (uint16_t)(bottom - top)};
+
+    ZELScratch *scratchSet = zelContextScratch(ctx);
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    /* dst addresses the canvas pixel under the visible rectangle's top-left corner. */
+    uint16_t *dst = canvas + (size_t)(top + originY) * canvasStridePixels +
+                    (size_t)(left + originX);
+    ZELClippedTarget target = {palette, &visible, dst, canvasStridePixels};
+    return zelVisitFrameZonesFiltered(ctx,
+                                      frameIndex,
+                                      scratchSet,
+                                      paletteCount,
+                                      zelClippedZoneVisible,
+                                      zelVisitClippedZone,
+                                      &target);
+}
+
 ZELResult zelDecodeFrameRgb565Zone(const ZELContext *ctx,
                                    uint32_t frameIndex,
                                    uint32_t zoneIndex,
@@ -494,14 +957,16 @@ ZELResult zelDecodeFrameRgb565Zone(const ZELContext *ctx,
     if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
         return ZEL_ERR_UNSUPPORTED_FORMAT;
 
+    ZELScratch *scratchSet = zelContextScratch(ctx);
     const uint16_t *palette = NULL;
     uint16_t paletteCount = 0;
-    ZELResult result = zelGetFramePalette(ctx, frameIndex, &palette, &paletteCount);
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
     if (result != ZEL_OK)
         return result;
 
     ZELFrameZoneStream stream;
-    result = zelInitFrameZoneStream(ctx, frameIndex, &stream);
+    result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
     if (result != ZEL_OK)
         return result;
 
@@ -510,11 +975,12 @@ ZELResult zelDecodeFrameRgb565Zone(const ZELContext *ctx,
 
     uint8_t *scratch = NULL;
     if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
-        scratch = zelAcquireZoneScratch(ctx, stream.layout.zonePixelBytes);
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
         if (!scratch)
             return ZEL_ERR_OUT_OF_MEMORY;
     }
 
+    const ZELBlitKernels *blit = ctx->blit;
     const uint8_t *chunkData = NULL;
     uint32_t chunkSize = 0;
     result = zelLocateZoneChunk(ctx, &stream, zoneIndex, &chunkData, &chunkSize);
@@ -522,14 +988,502 @@ ZELResult zelDecodeFrameRgb565Zone(const ZELContext *ctx,
         const uint8_t *zonePixels = NULL;
         result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, scratch, &zonePixels);
         if (result == ZEL_OK)
-            result = zelBlitZoneRgb(&stream.layout,
-                                    0,
-                                    zonePixels,
-                                    palette,
-                                    paletteCount,
-                                    dst,
-                                    stream.layout.zoneWidth);
+            result = blit->rgb(&stream.layout,
+                               0,
+                               zonePixels,
+                               palette,
+                               paletteCount,
+                               dst,
+                               stream.layout.zoneWidth);
     }
 
     return result;
 }
+
+ZELResult zelDecodeFrameRgb565ToZones(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      uint16_t *zoneBuffers,
+                                      ZELZoneSinkFunc sink,
+                                      void *userData) {
+    if (!ctx || !sink)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    ZELScratch *scratchSet = zelContextScratch(ctx);
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    ZELFrameZoneStream stream;
+    result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
+    if (result != ZEL_OK)
+        return result;
+
+    uint8_t *scratch = NULL;
+    if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
+        if (!scratch)
+            return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    /* Two zone buffers: the sink may still be reading one while the next zone is expanded. */
+    size_t zonePixelCount = stream.layout.zonePixelBytes;
+    if (!zoneBuffers) {
+        zoneBuffers = zelAcquireZoneRgbScratch(scratchSet, zonePixelCount * 2);
+        if (!zoneBuffers)
+            return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    int uncheckedIndices = ctx->trusted || paletteCount > UINT8_MAX;
+    const ZELBlitKernels *blit = ctx->blit;
+    uint16_t zoneWidth = stream.layout.zoneWidth;
+    uint16_t zoneHeight = stream.layout.zoneHeight;
+    size_t cursor = stream.zoneDataOffset;
+    for (uint32_t zoneIndex = 0; zoneIndex < stream.layout.zoneCount; ++zoneIndex) {
+        const uint8_t *chunkData = NULL;
+        uint32_t chunkSize = 0;
+        result = zelReadZoneChunkAtCursor(ctx, &stream, &cursor, &chunkData, &chunkSize);
+        if (result != ZEL_OK)
+            break;
+
+        const uint8_t *zonePixels = NULL;
+        result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, scratch, &zonePixels);
+        if (result != ZEL_OK)
+            break;
+
+        uint16_t *zoneRgb = zoneBuffers + (zoneIndex & 1u) * zonePixelCount;
+        if (uncheckedIndices)
+            blit->rgbUnchecked(&stream.layout, 0, zonePixels, palette, zoneRgb, zoneWidth);
+        else
+            result = blit->rgb(&stream.layout,
+                               0,
+                               zonePixels,
+                               palette,
+                               paletteCount,
+                               zoneRgb,
+                               zoneWidth);
+        if (result != ZEL_OK)
+            break;
+
+        uint16_t x = (uint16_t)((zoneIndex % stream.layout.zonesPerRow) * zoneWidth);
+        uint16_t y = (uint16_t)((zoneIndex / stream.layout.zonesPerRow) * zoneHeight);
+        result = sink(userData, x, y, zoneWidth, zoneHeight, zoneRgb);
+        if (result != ZEL_OK)
+            break;
+    }
+
+    if (result == ZEL_OK && cursor != stream.frameDataEnd)
+        result = ZEL_ERR_CORRUPT_DATA;
+
+    return result;
+}
+
+struct ZELFrameDecoder {
+    const ZELContext *ctx;
+    ZELScratch scratch;
+
+    int active;
+    ZELFrameZoneStream stream;
+    size_t cursor;
+    uint32_t nextZone;
+    const uint16_t *palette;
+    uint16_t paletteCount;
+    int uncheckedIndices;
+    uint8_t *zoneScratch;
+    uint16_t *dst;
+    size_t dstStridePixels;
+};
+
+ZELFrameDecoder *zelCreateFrameDecoder(const ZELContext *ctx, ZELResult *outResult) {
+    if (!ctx) {
+        if (outResult)
+            *outResult = ZEL_ERR_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    ZELFrameDecoder *decoder = (ZELFrameDecoder *)malloc(sizeof(ZELFrameDecoder));
+    if (!decoder) {
+        if (outResult)
+            *outResult = ZEL_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+
+    memset(decoder, 0, sizeof(ZELFrameDecoder));
+    decoder->ctx = ctx;
+    if (outResult)
+        *outResult = ZEL_OK;
+    return decoder;
+}
+
+void zelDestroyFrameDecoder(ZELFrameDecoder *decoder) {
+    if (!decoder)
+        return;
+
+    zelReleaseScratch(&decoder->scratch);
+    free(decoder);
+}
+
+ZELResult zelFrameDecoderBegin(ZELFrameDecoder *decoder,
+                               uint32_t frameIndex,
+                               uint16_t *dst,
+                               size_t dstStridePixels) {
+    if (!decoder || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    const ZELContext *ctx = decoder->ctx;
+    decoder->active = 0;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (dstStridePixels < ctx->header.width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* Everything the steps need lives in the decoder's own scratch, so other decodes on the
+       same context may run between steps. */
+    ZELResult result = zelResolveFramePalette(ctx,
+                                              frameIndex,
+                                              &decoder->scratch,
+                                              &decoder->palette,
+                                              &decoder->paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    result = zelInitFrameZoneStream(ctx, frameIndex, &decoder->scratch, &decoder->stream);
+    if (result != ZEL_OK)
+        return result;
+
+    decoder->zoneScratch = NULL;
+    if (decoder->stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
+        decoder->zoneScratch = zelAcquireZoneScratch(&decoder->scratch,
+                                                     decoder->stream.layout.zonePixelBytes);
+        if (!decoder->zoneScratch)
+            return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    decoder->uncheckedIndices = ctx->trusted || decoder->paletteCount > UINT8_MAX;
+    decoder->cursor = decoder->stream.zoneDataOffset;
+    decoder->nextZone = 0;
+    decoder->dst = dst;
+    decoder->dstStridePixels = dstStridePixels;
+    decoder->active = 1;
+    return ZEL_OK;
+}
+
+static ZELResult zelFrameDecoderDecodeZone(ZELFrameDecoder *decoder) {
+    const ZELContext *ctx = decoder->ctx;
+    ZELFrameZoneStream *stream = &decoder->stream;
+    const uint8_t *chunkData = NULL;
+    uint32_t chunkSize = 0;
+    ZELResult result =
+            zelReadZoneChunkAtCursor(ctx, stream, &decoder->cursor, &chunkData, &chunkSize);
+    if (result != ZEL_OK)
+        return result;
+
+    const uint8_t *zonePixels = NULL;
+    result = zelAccessZonePixels(ctx,
+                                 stream,
+                                 chunkData,
+                                 chunkSize,
+                                 decoder->zoneScratch,
+                                 &zonePixels);
+    if (result != ZEL_OK)
+        return result;
+
+    uint32_t zoneIndex = decoder->nextZone++;
+    if (decoder->uncheckedIndices) {
+        ctx->blit->rgbUnchecked(&stream->layout,
+                                zoneIndex,
+                                zonePixels,
+                                decoder->palette,
+                                decoder->dst,
+                                decoder->dstStridePixels);
+        return ZEL_OK;
+    }
+
+    return ctx->blit->rgb(&stream->layout,
+                          zoneIndex,
+                          zonePixels,
+                          decoder->palette,
+                          decoder->paletteCount,
+                          decoder->dst,
+                          decoder->dstStridePixels);
+}
+
+static ZELResult zelFrameDecoderFinishStep(ZELFrameDecoder *decoder,
+                                           ZELResult result,
+                                           int *outDone) {
+    int done = result != ZEL_OK || decoder->nextZone == decoder->stream.layout.zoneCount;
+    if (result == ZEL_OK && done && decoder->cursor != decoder->stream.frameDataEnd)
+        result = ZEL_ERR_CORRUPT_DATA;
+
+    if (done)
+        decoder->active = 0;
+    if (outDone)
+        *outDone = done;
+    return result;
+}
+
+ZELResult zelFrameDecoderStep(ZELFrameDecoder *decoder, uint32_t maxZones, int *outDone) {
+    if (!decoder || !decoder->active || maxZones == 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELResult result = ZEL_OK;
+    uint32_t zoneCount = decoder->stream.layout.zoneCount;
+    while (maxZones-- > 0 && decoder->nextZone < zoneCount) {
+        result = zelFrameDecoderDecodeZone(decoder);
+        if (result != ZEL_OK)
+            break;
+    }
+
+    return zelFrameDecoderFinishStep(decoder, result, outDone);
+}
+
+ZELResult zelFrameDecoderStepTimed(ZELFrameDecoder *decoder,
+                                   uint32_t budgetUs,
+                                   ZELClockFunc clock,
+                                   void *clockUserData,
+                                   int *outDone) {
+    if (!decoder || !decoder->active || !clock)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* At least one zone per step, so a tiny budget still makes progress. */
+    ZELResult result = ZEL_OK;
+    uint32_t zoneCount = decoder->stream.layout.zoneCount;
+    uint32_t start = clock(clockUserData);
+    while (decoder->nextZone < zoneCount) {
+        result = zelFrameDecoderDecodeZone(decoder);
+        if (result != ZEL_OK)
+            break;
+        if ((uint32_t)(clock(clockUserData) - start) >= budgetUs)
+            break;
+    }
+
+    return zelFrameDecoderFinishStep(decoder, result, outDone);
+}
+
+ZELResult zelVisitFrameZones(const ZELContext *ctx,
+                             uint32_t frameIndex,
+                             ZELScratch *scratchSet,
+                             uint16_t paletteCount,
+                             ZELZoneVisitFunc visit,
+                             void *userData) {
+    return zelVisitFrameZonesFiltered(ctx,
+                                      frameIndex,
+                                      scratchSet,
+                                      paletteCount,
+                                      NULL,
+                                      visit,
+                                      userData);
+}
+
+/* Advances *first to the next wanted zone and sets *last to the end of its run of adjacent
+   wanted zones. Returns 0 when no wanted zone is left. */
+static int zelNextWantedRun(const ZELChunkRange *ranges,
+                            uint32_t zoneCount,
+                            uint32_t *first,
+                            uint32_t *last) {
+    while (*first < zoneCount && ranges[*first].size == 0)
+        ++*first;
+    if (*first >= zoneCount)
+        return 0;
+
+    *last = *first;
+    while (*last + 1u < zoneCount && ranges[*last + 1u].size != 0)
+        ++*last;
+    return 1;
+}
+
+/* Fetches every run of wanted chunks into the frame-data scratch with one readv call and points
+   each wanted zone at its chunk there. */
+static ZELResult zelReadWantedRuns(const ZELContext *ctx,
+                                   ZELScratch *scratchSet,
+                                   ZELChunkRange *ranges,
+                                   uint32_t zoneCount,
+                                   uint32_t runCount,
+                                   size_t runBytes) {
+    ZELStreamRange *reads = zelAcquireReadRangeScratch(scratchSet, runCount);
+    uint8_t *buffer = zelAcquireFrameDataScratch(scratchSet, runBytes);
+    if (!reads || !buffer)
+        return ZEL_ERR_OUT_OF_MEMORY;
+
+    uint32_t runIndex = 0;
+    size_t used = 0;
+    for (uint32_t first = 0, last = 0; zelNextWantedRun(ranges, zoneCount, &first, &last);
+         first = last + 1u) {
+        size_t runOffset = ranges[first].offset;
+        size_t runSize = ranges[last].offset + ranges[last].size - runOffset;
+        reads[runIndex].offset = runOffset;
+        reads[runIndex].dst = buffer + used;
+        reads[runIndex].size = runSize;
+        for (uint32_t zoneIndex = first; zoneIndex <= last; ++zoneIndex)
+            ranges[zoneIndex].data = buffer + used + (ranges[zoneIndex].offset - runOffset);
+        used += runSize;
+        runIndex++;
+    }
+
+    if (ctx->streamReadv(ctx->stream.userData, reads, runCount) != runCount)
+        return ZEL_ERR_IO;
+    return ZEL_OK;
+}
+
+/* Zone-read mode with a filter, on a stream with a hint or readv callback: walks the size
+   prefixes first and records where the wanted chunks lie. Each run of adjacent wanted chunks
+   is hinted before any of them is read, and with readv all runs are fetched in one call. */
+static ZELResult zelLocateWantedZones(const ZELContext *ctx,
+                                      const ZELFrameZoneStream *stream,
+                                      ZELScratch *scratchSet,
+                                      ZELZoneFilterFunc filter,
+                                      void *userData,
+                                      const ZELChunkRange **outRanges) {
+    uint32_t zoneCount = stream->layout.zoneCount;
+    ZELChunkRange *ranges = zelAcquireChunkRangeScratch(scratchSet, zoneCount);
+    if (!ranges)
+        return ZEL_ERR_OUT_OF_MEMORY;
+
+    size_t cursor = stream->zoneDataOffset;
+    for (uint32_t zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex) {
+        const uint8_t *unused = NULL;
+        uint32_t chunkSize = 0;
+        size_t chunkOffset = cursor + sizeof(uint32_t);
+        ZELResult result = zelReadZoneChunkFromStream(ctx, stream, &cursor, 0, &unused, &chunkSize);
+        if (result != ZEL_OK)
+            return result;
+
+        ranges[zoneIndex].offset = chunkOffset;
+        ranges[zoneIndex].size = filter(userData, &stream->layout, zoneIndex) ? chunkSize : 0;
+        ranges[zoneIndex].data = NULL;
+    }
+
+    if (cursor != stream->frameDataEnd)
+        return ZEL_ERR_CORRUPT_DATA;
+
+    uint32_t runCount = 0;
+    size_t runBytes = 0;
+    for (uint32_t first = 0, last = 0; zelNextWantedRun(ranges, zoneCount, &first, &last);
+         first = last + 1u) {
+        size_t runOffset = ranges[first].offset;
+        size_t runSize = ranges[last].offset + ranges[last].size - runOffset;
+        if (ctx->streamHint)
+            ctx->streamHint(ctx->stream.userData, runOffset, runSize);
+        runCount++;
+        runBytes += runSize;
+    }
+
+    if (ctx->streamReadv && runCount > 0) {
+        ZELResult result =
+                zelReadWantedRuns(ctx, scratchSet, ranges, zoneCount, runCount, runBytes);
+        if (result != ZEL_OK)
+            return result;
+    }
+
+    *outRanges = ranges;
+    return ZEL_OK;
+}
+
+/* alwaysCheck keeps the index check on trusted contexts, whose validation only covered the
+   frame palettes. */
+static ZELResult zelVisitZones(const ZELContext *ctx,
+                               uint32_t frameIndex,
+                               ZELScratch *scratchSet,
+                               uint16_t paletteCount,
+                               int alwaysCheck,
+                               ZELZoneFilterFunc filter,
+                               ZELZoneVisitFunc visit,
+                               void *userData) {
+    ZELFrameZoneStream stream;
+    ZELResult result = zelInitFrameZoneStream(ctx, frameIndex, scratchSet, &stream);
+    if (result != ZEL_OK)
+        return result;
+
+    uint8_t *scratch = NULL;
+    if (stream.header.compressionType == ZEL_COMPRESSION_LZ4) {
+        scratch = zelAcquireZoneScratch(scratchSet, stream.layout.zonePixelBytes);
+        if (!scratch)
+            return ZEL_ERR_OUT_OF_MEMORY;
+    }
+
+    const ZELChunkRange *ranges = NULL;
+    size_t cursor = stream.zoneDataOffset;
+    if (!stream.frameData && filter && (ctx->streamHint || ctx->streamReadv)) {
+        result = zelLocateWantedZones(ctx, &stream, scratchSet, filter, userData, &ranges);
+        if (result != ZEL_OK)
+            return result;
+        cursor = stream.frameDataEnd;
+    }
+
+    int checkIndices = paletteCount > 0 && paletteCount <= UINT8_MAX
+                       && (alwaysCheck || !ctx->trusted);
+    for (uint32_t zoneIndex = 0; zoneIndex < stream.layout.zoneCount; ++zoneIndex) {
+        const uint8_t *chunkData = NULL;
+        uint32_t chunkSize = 0;
+
+        /* Filtered-out zones are stepped over without being decompressed, and in zone-read
+           mode without being read. */
+        int wanted = 1;
+        if (ranges) {
+            chunkSize = ranges[zoneIndex].size;
+            wanted = chunkSize != 0;
+            chunkData = ranges[zoneIndex].data;
+            if (wanted && !chunkData) {
+                result = zelLoadZoneChunk(ctx, &stream, ranges[zoneIndex].offset, chunkSize,
+                                          &chunkData);
+            }
+        } else if (!stream.frameData) {
+            wanted = !filter || filter(userData, &stream.layout, zoneIndex);
+            result = zelReadZoneChunkFromStream(ctx, &stream, &cursor, wanted, &chunkData,
+                                                &chunkSize);
+        } else {
+            result = zelReadZoneChunkAtCursor(ctx, &stream, &cursor, &chunkData, &chunkSize);
+            wanted = !filter || filter(userData, &stream.layout, zoneIndex);
+        }
+        if (result != ZEL_OK)
+            break;
+        if (!wanted)
+            continue;
+
+        const uint8_t *zonePixels = NULL;
+        result = zelAccessZonePixels(ctx, &stream, chunkData, chunkSize, scratch, &zonePixels);
+        if (result != ZEL_OK)
+            break;
+
+        if (checkIndices
+            && zelMaxIndex8(zonePixels, stream.layout.zonePixelBytes) >= paletteCount) {
+            result = ZEL_ERR_CORRUPT_DATA;
+            break;
+        }
+
+        result = visit(userData, &stream.layout, zoneIndex, zonePixels);
+        if (result != ZEL_OK)
+            break;
+    }
+
+    if (result == ZEL_OK && cursor != stream.frameDataEnd)
+        result = ZEL_ERR_CORRUPT_DATA;
+
+    return result;
+}
+
+ZELResult zelVisitFrameZonesFiltered(const ZELContext *ctx,
+                                     uint32_t frameIndex,
+                                     ZELScratch *scratchSet,
+                                     uint16_t paletteCount,
+                                     ZELZoneFilterFunc filter,
+                                     ZELZoneVisitFunc visit,
+                                     void *userData) {
+    return zelVisitZones(ctx, frameIndex, scratchSet, paletteCount, 0, filter, visit, userData);
+}
+
+ZELResult zelVisitFrameZonesBounded(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    ZELScratch *scratchSet,
+                                    uint16_t indexLimit,
+                                    ZELZoneVisitFunc visit,
+                                    void *userData) {
+    return zelVisitZones(ctx, frameIndex, scratchSet, indexLimit, 1, NULL, visit, userData);
+}
@@ -14,6 +14,39 @@ static inline uint32_t zelLe32(const uint8_t *p) {
     return (uint32_t)(p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
 }
 
+static inline uint16_t zelArgb4444ToRgb565(uint16_t value) {
+    uint32_t r = (value >> 8) & 0xFu;
+    uint32_t g = (value >> 4) & 0xFu;
+    uint32_t b = value & 0xFu;
+    return (uint16_t)((((r << 1) | (r >> 3)) << 11) | (((g << 2) | (g >> 2)) << 5)
+                      | ((b << 1) | (b >> 3)));
+}
+
+static inline uint8_t zelMaxIndex8(const uint8_t *indices, size_t count) {
+    uint8_t maxIndex = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] > maxIndex)
+            maxIndex = indices[i];
+    }
+    return maxIndex;
+}
+
+static inline void zelExpandRowRgb565(const uint8_t *src,
+                                      const uint16_t *palette,
+                                      uint16_t *dst,
+                                      uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i)
+        dst[i] = palette[src[i]];
+}
+
+static inline void zelExpandRow32(const uint8_t *src,
+                                  const uint32_t *palette,
+                                  uint32_t *dst,
+                                  uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i)
+        dst[i] = palette[src[i]];
+}
+
 typedef struct {
     uint16_t zoneWidth;
     uint16_t zoneHeight;
@@ -23,6 +56,94 @@ typedef struct {
     size_t zonePixelBytes;
 } ZELZoneLayout;
 
+typedef void (*ZELBlitIndicesFunc)(const ZELZoneLayout *layout,
+                                   uint32_t zoneIndex,
+                                   const uint8_t *zonePixels,
+                                   uint8_t *dst,
+                                   size_t dstStrideBytes);
+typedef ZELResult (*ZELBlitRgbFunc)(const ZELZoneLayout *layout,
+                                    uint32_t zoneIndex,
+                                    const uint8_t *zonePixels,
+                                    const uint16_t *palette,
+                                    uint16_t paletteCount,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels);
+typedef void (*ZELBlitRgbUncheckedFunc)(const ZELZoneLayout *layout,
+                                        uint32_t zoneIndex,
+                                        const uint8_t *zonePixels,
+                                        const uint16_t *palette,
+                                        uint16_t *dst,
+                                        size_t dstStridePixels);
+
+typedef struct {
+    ZELBlitIndicesFunc indices;
+    ZELBlitRgbFunc rgb;
+    ZELBlitRgbUncheckedFunc rgbUnchecked;
+} ZELBlitKernels;
+
+enum {
+    ZEL_BLEND_TRANSPARENT = 1,
+    ZEL_BLEND_OPAQUE = 2,
+    ZEL_BLEND_PARTIAL = 4
+};
+
+/* Per-entry data for zelBlendZoneRgb565. spread holds the little-endian RGB565 colour as
+   0x07E0F81F-masked fields so one multiply blends all three channels. */
+typedef struct {
+    uint16_t color[256];
+    uint32_t spread[256];
+    uint8_t alpha[256];
+    uint8_t kind[256];
+} ZELBlendPalette;
+
+/* Palette pre-converted to a packed format: three bytes per entry, or a 12-bit value in the
+   first two bytes (big-endian) for 444 formats. */
+typedef struct {
+    uint8_t bytes[256][3];
+    int nibbles;
+} ZELPackedPalette;
+
+/* Gray value of an entry at frame position (x, y):
+   level + ((mask >> (((y & 3) << 2) | (x & 3))) & 1). */
+typedef struct {
+    uint8_t level[256];
+    uint16_t mask[256];
+} ZELGrayPalette;
+
+typedef struct {
+    uint8_t red[32];
+    uint8_t green[64];
+    uint8_t blue[32];
+} ZELPaletteAdjustLut;
+
+/* Where a zone's chunk lies in the file; size 0 marks a zone the decode skips. data is set
+   once the chunk has been fetched in a batch. */
+typedef struct {
+    size_t offset;
+    uint32_t size;
+    const uint8_t *data;
+} ZELChunkRange;
+
+typedef struct {
+    uint8_t *zone;
+    size_t zoneCapacity;
+    uint8_t *frameData;
+    size_t frameDataCapacity;
+    uint16_t *palette;
+    size_t paletteCapacity;
+    uint16_t *zoneRgb;
+    size_t zoneRgbCapacity;
+    ZELBlendPalette *blend;
+    ZELPackedPalette *packed;
+    ZELGrayPalette *gray;
+    ZELChunkRange *chunkRanges;
+    size_t chunkRangeCapacity;
+    ZELStreamRange *readRanges;
+    size_t readRangeCapacity;
+    /* Index + 1 of the frame last loaded from the stream with this scratch, 0 if none. */
+    uint32_t lastStreamFrame;
+} ZELScratch;
+
 typedef struct {
     ZELFrameHeader header;
     size_t frameOffset;
@@ -31,15 +152,25 @@ typedef struct {
     size_t frameDataEnd;
     ZELZoneLayout layout;
     const uint8_t *frameData;
+    /* Zone-read mode only (frameData is NULL): chunks are read into the end of this buffer. */
+    uint8_t *chunkBuffer;
+    size_t chunkBufferSize;
 } ZELFrameZoneStream;
 
+/* Linux io_uring read-ahead of whole frame blocks; see zel_uring.c. */
+typedef struct ZELUringPrefetch ZELUringPrefetch;
+
 struct ZELContext {
     const uint8_t *data;
     size_t size;
 
     ZELInputStream stream;
+    ZELStreamHintFunc streamHint;
+    ZELStreamReadvFunc streamReadv;
 
     ZELFileHeader header;
+    ZELZoneLayout layout;
+    const ZELBlitKernels *blit;
 
     const ZELFrameIndexEntry *frameIndexTable;
     ZELFrameIndexEntry *frameIndexOwned;
@@ -54,20 +185,154 @@ struct ZELContext {
     int hasCustomOutputEncoding;
     ZELColorEncoding outputColorEncoding;
 
-    uint8_t *zoneScratch;
-    size_t zoneScratchCapacity;
-    uint8_t *frameDataScratch;
-    size_t frameDataScratchCapacity;
-    uint16_t *paletteScratch;
-    size_t paletteScratchCapacity;
+    ZELPaletteTransformFunc paletteTransform;
+    void *paletteTransformUserData;
+    ZELPaletteAdjustLut paletteAdjust;
+
+    int validated;
+    int trusted;
+    ZELStreamReadMode streamReadMode;
+    ZELUringPrefetch *prefetch;
+
+    /* Stream contexts opened with a preload policy: the stream is copied here from the start
+       and becomes data once preloadedBytes reaches size. */
+    uint8_t *preload;
+    size_t preloadedBytes;
+    size_t preloadChunkBytes;
+
+    ZELScratch scratch;
 };
 
 int zelIsValidColorEncoding(uint8_t encoding);
+int zelIsValidOutputEncoding(uint8_t encoding);
 uint16_t zelSwapRgb565(uint16_t value);
 int zelRangeFits(size_t offset, size_t length, size_t limit);
 ZELResult zelReadAt(const ZELContext *ctx, size_t offset, void *dst, size_t length);
-uint8_t *zelAcquireZoneScratch(const ZELContext *ctx, size_t neededBytes);
-uint16_t *zelAcquirePaletteScratch(const ZELContext *ctx, size_t neededEntries);
+int zelStreamDescriptor(const ZELInputStream *stream);
+/* Returns the frame block from a prefetch slot; it stays valid until the next call. */
+ZELResult zelPrefetchFrameBlock(ZELUringPrefetch *prefetch,
+                                uint32_t frameIndex,
+                                const uint8_t **outBytes);
+void zelDestroyUringPrefetch(ZELUringPrefetch *prefetch);
+const ZELBlitKernels *zelSelectBlitKernels(uint16_t zoneWidth, uint16_t zoneHeight);
+void zelBlitZoneRgbOriented(const ZELZoneLayout *layout,
+                            uint32_t zoneIndex,
+                            const uint8_t *zonePixels,
+                            const uint16_t *palette,
+                            ZELOrientation orientation,
+                            uint16_t *dst,
+                            size_t dstStridePixels);
+ZELScratch *zelContextScratch(const ZELContext *ctx);
+uint8_t *zelAcquireZoneScratch(ZELScratch *scratch, size_t neededBytes);
+uint8_t *zelAcquireFrameDataScratch(ZELScratch *scratch, size_t neededBytes);
+uint16_t *zelAcquirePaletteScratch(ZELScratch *scratch, size_t neededEntries);
+uint16_t *zelAcquireZoneRgbScratch(ZELScratch *scratch, size_t neededPixels);
+ZELBlendPalette *zelAcquireBlendScratch(ZELScratch *scratch);
+ZELPackedPalette *zelAcquirePackedScratch(ZELScratch *scratch);
+ZELGrayPalette *zelAcquireGrayScratch(ZELScratch *scratch);
+ZELChunkRange *zelAcquireChunkRangeScratch(ZELScratch *scratch, size_t neededRanges);
+ZELStreamRange *zelAcquireReadRangeScratch(ZELScratch *scratch, size_t neededRanges);
+void zelReleaseScratch(ZELScratch *scratch);
+ZELResult zelResolveGlobalPalette(const ZELContext *ctx,
+                                  const uint16_t **outEntries,
+                                  uint16_t *outCount);
+ZELResult zelResolveFramePalette(const ZELContext *ctx,
+                                 uint32_t frameIndex,
+                                 ZELScratch *scratch,
+                                 const uint16_t **outEntries,
+                                 uint16_t *outCount);
+ZELResult zelResolveFramePaletteAlpha(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      ZELScratch *scratch,
+                                      uint8_t *outAlpha,
+                                      uint16_t *outCount);
+ZELResult zelValidateFrameWithScratch(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      ZELScratch *scratch,
+                                      uint32_t *outZoneIndex);
+void zelBlendZoneRgb565(const ZELZoneLayout *layout,
+                        uint32_t zoneIndex,
+                        const uint8_t *zonePixels,
+                        const ZELBlendPalette *blend,
+                        int swapBytes,
+                        uint16_t *dst,
+                        size_t dstStridePixels);
+void zelBlitZoneRgbClipped(const ZELZoneLayout *layout,
+                           uint32_t zoneIndex,
+                           const uint8_t *zonePixels,
+                           const uint16_t *palette,
+                           const ZELRect *visible,
+                           uint16_t *dst,
+                           size_t dstStridePixels);
+void zelBlitZoneRgbKeyed(const ZELZoneLayout *layout,
+                         uint32_t zoneIndex,
+                         const uint8_t *zonePixels,
+                         const uint16_t *palette,
+                         uint8_t key,
+                         const ZELRect *visible,
+                         uint16_t *dst,
+                         size_t dstStridePixels);
+void zelBlitZoneLut(const ZELZoneLayout *layout,
+                    uint32_t zoneIndex,
+                    const uint8_t *zonePixels,
+                    const uint8_t *lut,
+                    uint32_t elementSize,
+                    uint8_t *dst,
+                    size_t dstPitchBytes);
+void zelBlitZonePacked(const ZELZoneLayout *layout,
+                       uint32_t zoneIndex,
+                       const uint8_t *zonePixels,
+                       const ZELPackedPalette *packed,
+                       uint8_t *dst,
+                       size_t dstStrideBytes);
+void zelBlitZoneGray(const ZELZoneLayout *layout,
+                     uint32_t zoneIndex,
+                     const uint8_t *zonePixels,
+                     const ZELGrayPalette *gray,
+                     ZELGrayFormat format,
+                     uint8_t *dst,
+                     size_t dstStrideBytes);
+/* Calls visit for each zone of a frame in storage order. Indices are checked against
+   paletteCount unless it is 0, above 255, or the context is trusted. */
+typedef ZELResult (*ZELZoneVisitFunc)(void *userData,
+                                      const ZELZoneLayout *layout,
+                                      uint32_t zoneIndex,
+                                      const uint8_t *zonePixels);
+ZELResult zelVisitFrameZones(const ZELContext *ctx,
+                             uint32_t frameIndex,
+                             ZELScratch *scratch,
+                             uint16_t paletteCount,
+                             ZELZoneVisitFunc visit,
+                             void *userData);
+/* As zelVisitFrameZones, but zones for which filter returns 0 are skipped before decompression.
+   Both callbacks receive userData. A NULL filter visits every zone. */
+typedef int (*ZELZoneFilterFunc)(void *userData, const ZELZoneLayout *layout, uint32_t zoneIndex);
+ZELResult zelVisitFrameZonesFiltered(const ZELContext *ctx,
+                                     uint32_t frameIndex,
+                                     ZELScratch *scratch,
+                                     uint16_t paletteCount,
+                                     ZELZoneFilterFunc filter,
+                                     ZELZoneVisitFunc visit,
+                                     void *userData);
+/* As zelVisitFrameZones for tables the caller supplies after validation: indices are checked
+   against indexLimit (when 1..255) even on trusted contexts. */
+ZELResult zelVisitFrameZonesBounded(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    ZELScratch *scratch,
+                                    uint16_t indexLimit,
+                                    ZELZoneVisitFunc visit,
+                                    void *userData);
+ZELResult zelDecodeFrameRgb565WithScratch(const ZELContext *ctx,
+                                          uint32_t frameIndex,
+                                          ZELScratch *scratch,
+                                          uint16_t *dst,
+                                          size_t dstStridePixels);
+ZELResult zelDecodeFrameRgb565OrientedWithScratch(const ZELContext *ctx,
+                                                  uint32_t frameIndex,
+                                                  ZELScratch *scratch,
+                                                  ZELOrientation orientation,
+                                                  uint16_t *dst,
+                                                  size_t dstStridePixels);
 ZELColorEncoding zelSelectOutputEncoding(const ZELContext *ctx, ZELColorEncoding sourceEncoding);
 void zelParseFileHeader(const uint8_t *src, ZELFileHeader *out);
 void zelParsePaletteHeader(const uint8_t *src, ZELPaletteHeader *out);
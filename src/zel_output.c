@@ -0,0 +1,365 @@
+#include "zel_internal.h"
+
+#include <string.h>
+
+/* Decoders for output formats other than plain RGB565. Each one converts the frame palette
+   into a per-entry table once and then visits the zones with a format-specific blit. */
+
+typedef struct {
+    const ZELBlendPalette *blend;
+    int swapBytes;
+    uint16_t *dst;
+    size_t dstStridePixels;
+} ZELBlendTarget;
+
+static ZELResult zelVisitBlendZone(void *userData,
+                                   const ZELZoneLayout *layout,
+                                   uint32_t zoneIndex,
+                                   const uint8_t *zonePixels) {
+    const ZELBlendTarget *target = (const ZELBlendTarget *)userData;
+    zelBlendZoneRgb565(layout,
+                       zoneIndex,
+                       zonePixels,
+                       target->blend,
+                       target->swapBytes,
+                       target->dst,
+                       target->dstStridePixels);
+    return ZEL_OK;
+}
+
+ZELResult zelDecodeFrameRgb565Blend(const ZELContext *ctx,
+                                    uint32_t frameIndex,
+                                    uint16_t *dst,
+                                    size_t dstStridePixels) {
+    if (!ctx || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (dstStridePixels < ctx->header.width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELScratch *scratchSet = zelContextScratch(ctx);
+    ZELBlendPalette *blend = zelAcquireBlendScratch(scratchSet);
+    if (!blend)
+        return ZEL_ERR_OUT_OF_MEMORY;
+
+    /* Alpha comes from the stored entries, colour from the resolved (transformed) palette. */
+    uint16_t alphaCount = 0;
+    ZELResult result =
+            zelResolveFramePaletteAlpha(ctx, frameIndex, scratchSet, blend->alpha, &alphaCount);
+    if (result != ZEL_OK)
+        return result;
+
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    result = zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    int swapBytes = zelSelectOutputEncoding(ctx, ZEL_COLOR_RGB565_LE) == ZEL_COLOR_RGB565_BE;
+    uint16_t usedCount = paletteCount > 256 ? 256 : paletteCount;
+    for (uint16_t i = 0; i < usedCount; ++i) {
+        uint16_t color = palette[i];
+        uint16_t le = swapBytes ? zelSwapRgb565(color) : color;
+        uint8_t alpha = blend->alpha[i];
+        blend->color[i] = color;
+        blend->spread[i] = (le | ((uint32_t)le << 16)) & 0x07E0F81Fu;
+        blend->kind[i] = alpha == 0    ? ZEL_BLEND_TRANSPARENT
+                         : alpha == 32 ? ZEL_BLEND_OPAQUE
+                                       : ZEL_BLEND_PARTIAL;
+    }
+    /* Out-of-range indices are rejected by the visit unless the context is trusted. */
+    for (uint16_t i = usedCount; i < 256; ++i) {
+        blend->color[i] = 0;
+        blend->spread[i] = 0;
+        blend->alpha[i] = 0;
+        blend->kind[i] = ZEL_BLEND_TRANSPARENT;
+    }
+
+    ZELBlendTarget target = {blend, swapBytes, dst, dstStridePixels};
+    return zelVisitFrameZones(ctx,
+                              frameIndex,
+                              scratchSet,
+                              paletteCount,
+                              zelVisitBlendZone,
+                              &target);
+}
+
+static void zelBuildPackedPalette(const uint16_t *palette,
+                                  uint16_t count,
+                                  int swapBytes,
+                                  ZELPackedFormat format,
+                                  ZELPackedPalette *outPacked) {
+    int bgr = format == ZEL_PACKED_BGR444 || format == ZEL_PACKED_BGR666
+              || format == ZEL_PACKED_BGR888;
+    outPacked->nibbles = format == ZEL_PACKED_RGB444 || format == ZEL_PACKED_BGR444;
+
+    memset(outPacked->bytes, 0, sizeof(outPacked->bytes));
+    uint16_t usedCount = count > 256 ? 256 : count;
+    for (uint16_t i = 0; i < usedCount; ++i) {
+        uint16_t value = swapBytes ? zelSwapRgb565(palette[i]) : palette[i];
+        uint32_t r = (value >> 11) & 0x1Fu;
+        uint32_t g = (value >> 5) & 0x3Fu;
+        uint32_t b = value & 0x1Fu;
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+        if (bgr) {
+            uint32_t t = r;
+            r = b;
+            b = t;
+        }
+
+        uint8_t *entry = outPacked->bytes[i];
+        if (outPacked->nibbles) {
+            entry[0] = (uint8_t)(r >> 4);
+            entry[1] = (uint8_t)((g & 0xF0u) | (b >> 4));
+        } else if (format == ZEL_PACKED_RGB666 || format == ZEL_PACKED_BGR666) {
+            entry[0] = (uint8_t)(r & 0xFCu);
+            entry[1] = (uint8_t)(g & 0xFCu);
+            entry[2] = (uint8_t)(b & 0xFCu);
+        } else {
+            entry[0] = (uint8_t)r;
+            entry[1] = (uint8_t)g;
+            entry[2] = (uint8_t)b;
+        }
+    }
+}
+
+typedef struct {
+    const ZELPackedPalette *packed;
+    uint8_t *dst;
+    size_t dstStrideBytes;
+} ZELPackedTarget;
+
+static ZELResult zelVisitPackedZone(void *userData,
+                                    const ZELZoneLayout *layout,
+                                    uint32_t zoneIndex,
+                                    const uint8_t *zonePixels) {
+    const ZELPackedTarget *target = (const ZELPackedTarget *)userData;
+    zelBlitZonePacked(layout,
+                      zoneIndex,
+                      zonePixels,
+                      target->packed,
+                      target->dst,
+                      target->dstStrideBytes);
+    return ZEL_OK;
+}
+
+ZELResult zelDecodeFramePacked(const ZELContext *ctx,
+                               uint32_t frameIndex,
+                               ZELPackedFormat format,
+                               uint8_t *dst,
+                               size_t dstStrideBytes) {
+    if (!ctx || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if ((unsigned)format > (unsigned)ZEL_PACKED_BGR888)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    size_t width = ctx->header.width;
+    int nibbles = format == ZEL_PACKED_RGB444 || format == ZEL_PACKED_BGR444;
+    size_t rowBytes = nibbles ? (width * 3 + 1) / 2 : width * 3;
+    if (dstStrideBytes < rowBytes)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELScratch *scratchSet = zelContextScratch(ctx);
+    ZELPackedPalette *packed = zelAcquirePackedScratch(scratchSet);
+    if (!packed)
+        return ZEL_ERR_OUT_OF_MEMORY;
+
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    /* Converted once per frame; the blit then only copies bytes. */
+    int swapBytes = zelSelectOutputEncoding(ctx, ZEL_COLOR_RGB565_LE) == ZEL_COLOR_RGB565_BE;
+    zelBuildPackedPalette(palette, paletteCount, swapBytes, format, packed);
+
+    ZELPackedTarget target = {packed, dst, dstStrideBytes};
+    return zelVisitFrameZones(ctx,
+                              frameIndex,
+                              scratchSet,
+                              paletteCount,
+                              zelVisitPackedZone,
+                              &target);
+}
+
+/* 4x4 ordered-dither thresholds, indexed by ((y & 3) << 2) | (x & 3). */
+static const uint8_t zelBayer4x4[16] = {0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5};
+
+static void zelBuildGrayPalette(const uint16_t *palette,
+                                uint16_t count,
+                                int swapBytes,
+                                uint32_t maxLevel,
+                                int dither,
+                                ZELGrayPalette *outGray) {
+    memset(outGray, 0, sizeof(*outGray));
+    uint16_t usedCount = count > 256 ? 256 : count;
+    for (uint16_t i = 0; i < usedCount; ++i) {
+        uint16_t value = swapBytes ? zelSwapRgb565(palette[i]) : palette[i];
+        uint32_t r = (value >> 11) & 0x1Fu;
+        uint32_t g = (value >> 5) & 0x3Fu;
+        uint32_t b = value & 0x1Fu;
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+        uint32_t luma = (r * 77u + g * 150u + b * 29u + 128u) >> 8;
+
+        /* Each entry becomes a base level plus a mask of the dither positions that round up,
+           so thresholding and dithering cost the same in the blit. */
+        uint32_t scaled = luma * maxLevel;
+        uint32_t level = scaled / 255u;
+        uint32_t remainder = scaled % 255u;
+        uint16_t mask = 0;
+        if (level < maxLevel) {
+            for (uint32_t pos = 0; pos < 16; ++pos) {
+                int roundUp = dither ? remainder * 16u > zelBayer4x4[pos] * 255u + 127u
+                                     : remainder * 2u >= 255u;
+                if (roundUp)
+                    mask = (uint16_t)(mask | (1u << pos));
+            }
+        }
+
+        outGray->level[i] = (uint8_t)level;
+        outGray->mask[i] = mask;
+    }
+}
+
+typedef struct {
+    const ZELGrayPalette *gray;
+    ZELGrayFormat format;
+    uint8_t *dst;
+    size_t dstStrideBytes;
+} ZELGrayTarget;
+
+static ZELResult zelVisitGrayZone(void *userData,
+                                  const ZELZoneLayout *layout,
+                                  uint32_t zoneIndex,
+                                  const uint8_t *zonePixels) {
+    const ZELGrayTarget *target = (const ZELGrayTarget *)userData;
+    zelBlitZoneGray(layout,
+                    zoneIndex,
+                    zonePixels,
+                    target->gray,
+                    target->format,
+                    target->dst,
+                    target->dstStrideBytes);
+    return ZEL_OK;
+}
+
+ZELResult zelDecodeFrameGray(const ZELContext *ctx,
+                             uint32_t frameIndex,
+                             ZELGrayFormat format,
+                             int dither,
+                             uint8_t *dst,
+                             size_t dstStrideBytes) {
+    if (!ctx || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    size_t width = ctx->header.width;
+    size_t rowBytes = 0;
+    switch (format) {
+        case ZEL_GRAY_MONO1_ROWS:
+            rowBytes = (width + 7) / 8;
+            break;
+        case ZEL_GRAY_MONO1_PAGES:
+            rowBytes = width;
+            break;
+        case ZEL_GRAY_GRAY4_ROWS:
+            rowBytes = (width + 1) / 2;
+            break;
+        default:
+            return ZEL_ERR_INVALID_ARGUMENT;
+    }
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (dstStrideBytes < rowBytes)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELScratch *scratchSet = zelContextScratch(ctx);
+    ZELGrayPalette *gray = zelAcquireGrayScratch(scratchSet);
+    if (!gray)
+        return ZEL_ERR_OUT_OF_MEMORY;
+
+    const uint16_t *palette = NULL;
+    uint16_t paletteCount = 0;
+    ZELResult result =
+            zelResolveFramePalette(ctx, frameIndex, scratchSet, &palette, &paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    int swapBytes = zelSelectOutputEncoding(ctx, ZEL_COLOR_RGB565_LE) == ZEL_COLOR_RGB565_BE;
+    uint32_t maxLevel = format == ZEL_GRAY_GRAY4_ROWS ? 15u : 1u;
+    zelBuildGrayPalette(palette, paletteCount, swapBytes, maxLevel, dither, gray);
+
+    ZELGrayTarget target = {gray, format, dst, dstStrideBytes};
+    return zelVisitFrameZones(ctx,
+                              frameIndex,
+                              scratchSet,
+                              paletteCount,
+                              zelVisitGrayZone,
+                              &target);
+}
+
+typedef struct {
+    const uint8_t *lut;
+    uint32_t elementSize;
+    uint8_t *dst;
+    size_t dstPitchBytes;
+} ZELLutTarget;
+
+static ZELResult zelVisitLutZone(void *userData,
+                                 const ZELZoneLayout *layout,
+                                 uint32_t zoneIndex,
+                                 const uint8_t *zonePixels) {
+    const ZELLutTarget *target = (const ZELLutTarget *)userData;
+    zelBlitZoneLut(layout,
+                   zoneIndex,
+                   zonePixels,
+                   target->lut,
+                   target->elementSize,
+                   target->dst,
+                   target->dstPitchBytes);
+    return ZEL_OK;
+}
+
+ZELResult zelDecodeFrameLut(const ZELContext *ctx,
+                            uint32_t frameIndex,
+                            const void *lut,
+                            uint16_t lutCount,
+                            uint32_t elementSize,
+                            void *dst,
+                            size_t dstPitchBytes) {
+    if (!ctx || !lut || !dst || lutCount == 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (elementSize < 1 || elementSize > 4)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (ctx->header.colorFormat != ZEL_COLOR_FORMAT_INDEXED8)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    if (dstPitchBytes < (size_t)ctx->header.width * elementSize)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* The caller's table replaces the palette, and validation never saw it, so its size bounds
+       the indices even on trusted contexts. */
+    ZELLutTarget target = {(const uint8_t *)lut, elementSize, (uint8_t *)dst, dstPitchBytes};
+    return zelVisitFrameZonesBounded(ctx,
+                                     frameIndex,
+                                     zelContextScratch(ctx),
+                                     lutCount,
+                                     zelVisitLutZone,
+                                     &target);
+}
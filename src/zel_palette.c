@@ -9,7 +9,16 @@ static void zelConvertPaletteEncoding(const uint16_t *src,
                                       ZELColorEncoding srcEncoding,
                                       ZELColorEncoding dstEncoding) {
     if (srcEncoding == dstEncoding) {
-        memcpy(dst, src, (size_t)count * sizeof(uint16_t));
+        if (dst != src)
+            memcpy(dst, src, (size_t)count * sizeof(uint16_t));
+        return;
+    }
+
+    if (srcEncoding == ZEL_COLOR_ARGB4444_LE) {
+        for (uint16_t i = 0; i < count; ++i) {
+            uint16_t value = zelArgb4444ToRgb565(src[i]);
+            dst[i] = dstEncoding == ZEL_COLOR_RGB565_BE ? zelSwapRgb565(value) : value;
+        }
         return;
     }
 
@@ -17,15 +26,27 @@ static void zelConvertPaletteEncoding(const uint16_t *src,
         dst[i] = zelSwapRgb565(src[i]);
 }
 
-static ZELResult zelResolveGlobalPalette(const ZELContext *ctx,
-                                         const uint16_t **outEntries,
-                                         uint16_t *outCount) {
+/* Alpha on a 0..32 scale, the range the RGB565 blend kernel multiplies by. */
+static void zelExtractPaletteAlpha(const uint16_t *entries,
+                                   uint16_t count,
+                                   ZELColorEncoding encoding,
+                                   uint8_t *outAlpha) {
+    uint16_t used = count > 256 ? 256 : count;
+    for (uint16_t i = 0; i < used; ++i) {
+        uint32_t alpha4 = encoding == ZEL_COLOR_ARGB4444_LE ? entries[i] >> 12 : 0xFu;
+        outAlpha[i] = (uint8_t)((alpha4 * 32u + 7u) / 15u);
+    }
+}
+
+ZELResult zelResolveGlobalPalette(const ZELContext *ctx,
+                                  const uint16_t **outEntries,
+                                  uint16_t *outCount) {
     if (!ctx->globalPaletteRaw)
         return ZEL_ERR_OUT_OF_BOUNDS;
 
     ZELColorEncoding desired = zelSelectOutputEncoding(ctx, ctx->globalPaletteEncoding);
 
-    if (desired == ctx->globalPaletteEncoding) {
+    if (desired == ctx->globalPaletteEncoding && !ctx->paletteTransform) {
         *outEntries = ctx->globalPaletteRaw;
         *outCount = ctx->globalPaletteCount;
         return ZEL_OK;
@@ -50,6 +71,11 @@ static ZELResult zelResolveGlobalPalette(const ZELContext *ctx,
                                   ctx->globalPaletteCount,
                                   ctx->globalPaletteEncoding,
                                   desired);
+        if (ctx->paletteTransform)
+            ctx->paletteTransform(ctx->paletteTransformUserData,
+                                  mutableCtx->globalPaletteConverted,
+                                  ctx->globalPaletteCount,
+                                  desired);
         mutableCtx->globalPaletteConvertedEncoding = desired;
     }
 
@@ -59,6 +85,7 @@ static ZELResult zelResolveGlobalPalette(const ZELContext *ctx,
 }
 
 static ZELResult zelResolveLocalPalette(const ZELContext *ctx,
+                                        ZELScratch *scratchSet,
                                         const ZELPaletteHeader *ph,
                                         const uint16_t *paletteData,
                                         const uint16_t **outEntries,
@@ -66,23 +93,92 @@ static ZELResult zelResolveLocalPalette(const ZELContext *ctx,
     ZELColorEncoding sourceEncoding = (ZELColorEncoding)ph->colorEncoding;
     ZELColorEncoding desired = zelSelectOutputEncoding(ctx, sourceEncoding);
 
-    if (desired == sourceEncoding) {
+    if (desired == sourceEncoding && !ctx->paletteTransform) {
         *outEntries = paletteData;
         *outCount = ph->entryCount;
         return ZEL_OK;
     }
 
-    uint16_t *scratch = zelAcquirePaletteScratch(ctx, ph->entryCount);
+    uint16_t *scratch = zelAcquirePaletteScratch(scratchSet, ph->entryCount);
     if (!scratch)
         return ZEL_ERR_OUT_OF_MEMORY;
 
     zelConvertPaletteEncoding(paletteData, scratch, ph->entryCount, sourceEncoding, desired);
+    if (ctx->paletteTransform)
+        ctx->paletteTransform(ctx->paletteTransformUserData, scratch, ph->entryCount, desired);
 
     *outEntries = scratch;
     *outCount = ph->entryCount;
     return ZEL_OK;
 }
 
+static void zelApplyPaletteAdjust(void *userData,
+                                  uint16_t *entries,
+                                  uint16_t count,
+                                  ZELColorEncoding encoding) {
+    const ZELPaletteAdjustLut *lut = (const ZELPaletteAdjustLut *)userData;
+
+    for (uint16_t i = 0; i < count; ++i) {
+        uint16_t value = encoding == ZEL_COLOR_RGB565_BE ? zelSwapRgb565(entries[i]) : entries[i];
+        value = (uint16_t)(((uint16_t)lut->red[value >> 11] << 11)
+                           | ((uint16_t)lut->green[(value >> 5) & 0x3Fu] << 5)
+                           | lut->blue[value & 0x1Fu]);
+        entries[i] = encoding == ZEL_COLOR_RGB565_BE ? zelSwapRgb565(value) : value;
+    }
+}
+
+static void zelBuildChannelLut(uint8_t *lut,
+                               uint32_t levels,
+                               uint32_t scale,
+                               const uint8_t *gammaLut) {
+    uint32_t maxLevel = levels - 1;
+    for (uint32_t level = 0; level < levels; ++level) {
+        uint32_t value8 = (level * 255u + maxLevel / 2) / maxLevel;
+        value8 = (value8 * scale + 128u) >> 8;
+        if (value8 > 255u)
+            value8 = 255u;
+        if (gammaLut)
+            value8 = gammaLut[value8];
+        lut[level] = (uint8_t)((value8 * maxLevel + 127u) / 255u);
+    }
+}
+
+void zelSetPaletteTransform(ZELContext *ctx, ZELPaletteTransformFunc transform, void *userData) {
+    if (!ctx)
+        return;
+
+    ctx->paletteTransform = transform;
+    ctx->paletteTransformUserData = transform ? userData : NULL;
+    ctx->globalPaletteConvertedEncoding = (ZELColorEncoding)255;
+}
+
+ZELResult zelSetPaletteAdjust(ZELContext *ctx, const ZELPaletteAdjust *adjust) {
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (!adjust) {
+        zelSetPaletteTransform(ctx, NULL, NULL);
+        return ZEL_OK;
+    }
+
+    uint32_t brightness = adjust->brightness;
+    zelBuildChannelLut(ctx->paletteAdjust.red,
+                       32,
+                       (brightness * adjust->tintRed + 128u) >> 8,
+                       adjust->gammaLut);
+    zelBuildChannelLut(ctx->paletteAdjust.green,
+                       64,
+                       (brightness * adjust->tintGreen + 128u) >> 8,
+                       adjust->gammaLut);
+    zelBuildChannelLut(ctx->paletteAdjust.blue,
+                       32,
+                       (brightness * adjust->tintBlue + 128u) >> 8,
+                       adjust->gammaLut);
+
+    zelSetPaletteTransform(ctx, zelApplyPaletteAdjust, &ctx->paletteAdjust);
+    return ZEL_OK;
+}
+
 ZELResult zelGetGlobalPalette(const ZELContext *ctx,
                               const uint16_t **outEntries,
                               uint16_t *outCount) {
@@ -92,21 +188,11 @@ ZELResult zelGetGlobalPalette(const ZELContext *ctx,
     return zelResolveGlobalPalette(ctx, outEntries, outCount);
 }
 
-ZELResult zelGetFramePalette(const ZELContext *ctx,
-                             uint32_t frameIndex,
-                             const uint16_t **outEntries,
-                             uint16_t *outCount) {
-    if (!ctx || !outEntries || !outCount)
-        return ZEL_ERR_INVALID_ARGUMENT;
-
-    if (frameIndex >= ctx->header.frameCount)
-        return ZEL_ERR_OUT_OF_BOUNDS;
-
-    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
-
-    if (!fi->flags.hasLocalPalette)
-        return zelResolveGlobalPalette(ctx, outEntries, outCount);
-
+static ZELResult zelLoadLocalPalette(const ZELContext *ctx,
+                                    const ZELFrameIndexEntry *fi,
+                                    ZELScratch *scratchSet,
+                                    ZELPaletteHeader *outHeader,
+                                    const uint16_t **outData) {
     size_t frameOffset = fi->frameOffset;
     size_t frameSize = fi->frameSize;
 
@@ -167,7 +253,7 @@ ZELResult zelGetFramePalette(const ZELContext *ctx,
     if (ctx->data) {
         paletteData = (const uint16_t *)(ctx->data + paletteDataOffset);
     } else {
-        uint16_t *scratch = zelAcquirePaletteScratch(ctx, ph.entryCount);
+        uint16_t *scratch = zelAcquirePaletteScratch(scratchSet, ph.entryCount);
         if (!scratch)
             return ZEL_ERR_OUT_OF_MEMORY;
         result = zelReadAt(ctx, paletteDataOffset, scratch, paletteBytes);
@@ -176,5 +262,74 @@ ZELResult zelGetFramePalette(const ZELContext *ctx,
         paletteData = scratch;
     }
 
-    return zelResolveLocalPalette(ctx, &ph, paletteData, outEntries, outCount);
+    *outHeader = ph;
+    *outData = paletteData;
+    return ZEL_OK;
+}
+
+ZELResult zelResolveFramePalette(const ZELContext *ctx,
+                                 uint32_t frameIndex,
+                                 ZELScratch *scratchSet,
+                                 const uint16_t **outEntries,
+                                 uint16_t *outCount) {
+    if (frameIndex >= ctx->header.frameCount)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+
+    if (!fi->flags.hasLocalPalette)
+        return zelResolveGlobalPalette(ctx, outEntries, outCount);
+
+    ZELPaletteHeader ph;
+    const uint16_t *paletteData = NULL;
+    ZELResult result = zelLoadLocalPalette(ctx, fi, scratchSet, &ph, &paletteData);
+    if (result != ZEL_OK)
+        return result;
+
+    return zelResolveLocalPalette(ctx, scratchSet, &ph, paletteData, outEntries, outCount);
+}
+
+ZELResult zelResolveFramePaletteAlpha(const ZELContext *ctx,
+                                      uint32_t frameIndex,
+                                      ZELScratch *scratchSet,
+                                      uint8_t *outAlpha,
+                                      uint16_t *outCount) {
+    if (frameIndex >= ctx->header.frameCount)
+        return ZEL_ERR_OUT_OF_BOUNDS;
+
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+
+    if (!fi->flags.hasLocalPalette) {
+        if (!ctx->globalPaletteRaw)
+            return ZEL_ERR_OUT_OF_BOUNDS;
+        zelExtractPaletteAlpha(ctx->globalPaletteRaw,
+                               ctx->globalPaletteCount,
+                               ctx->globalPaletteEncoding,
+                               outAlpha);
+        *outCount = ctx->globalPaletteCount;
+        return ZEL_OK;
+    }
+
+    ZELPaletteHeader ph;
+    const uint16_t *paletteData = NULL;
+    ZELResult result = zelLoadLocalPalette(ctx, fi, scratchSet, &ph, &paletteData);
+    if (result != ZEL_OK)
+        return result;
+
+    zelExtractPaletteAlpha(paletteData,
+                           ph.entryCount,
+                           (ZELColorEncoding)ph.colorEncoding,
+                           outAlpha);
+    *outCount = ph.entryCount;
+    return ZEL_OK;
+}
+
+ZELResult zelGetFramePalette(const ZELContext *ctx,
+                             uint32_t frameIndex,
+                             const uint16_t **outEntries,
+                             uint16_t *outCount) {
+    if (!ctx || !outEntries || !outCount)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    return zelResolveFramePalette(ctx, frameIndex, zelContextScratch(ctx), outEntries, outCount);
 }
@@ -0,0 +1,145 @@
+#include "zel_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct ZELPlayer {
+    const ZELContext *ctx;
+    /* frameEndMs[i] is the end of frame i within one loop; the last entry is the loop length. */
+    uint32_t *frameEndMs;
+    uint32_t frameCount;
+
+    uint32_t lastNowMs;
+    uint64_t elapsedMs;
+    int hasFrame;
+    uint32_t lastFrameIndex;
+    uint64_t lastPosition;
+    uint32_t droppedFrames;
+};
+
+ZELPlayer *zelCreatePlayer(const ZELContext *ctx, uint32_t startMs, ZELResult *outResult) {
+    ZELResult result = ZEL_OK;
+    ZELPlayer *player = NULL;
+
+    if (!ctx || ctx->header.frameCount == 0) {
+        result = ZEL_ERR_INVALID_ARGUMENT;
+        goto fail;
+    }
+
+    player = (ZELPlayer *)malloc(sizeof(ZELPlayer));
+    if (!player) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    memset(player, 0, sizeof(ZELPlayer));
+    player->ctx = ctx;
+    player->frameCount = ctx->header.frameCount;
+    player->frameEndMs = (uint32_t *)malloc((size_t)player->frameCount * sizeof(uint32_t));
+    if (!player->frameEndMs) {
+        result = ZEL_ERR_OUT_OF_MEMORY;
+        goto fail;
+    }
+
+    uint32_t accum = 0;
+    for (uint32_t i = 0; i < player->frameCount; ++i) {
+        uint16_t duration = 0;
+        result = zelGetFrameDurationMs(ctx, i, &duration);
+        if (result != ZEL_OK)
+            goto fail;
+        accum += duration;
+        player->frameEndMs[i] = accum;
+    }
+
+    if (accum == 0) {
+        result = ZEL_ERR_CORRUPT_DATA;
+        goto fail;
+    }
+
+    zelPlayerReset(player, startMs);
+    if (outResult)
+        *outResult = ZEL_OK;
+    return player;
+
+fail:
+    zelDestroyPlayer(player);
+    if (outResult)
+        *outResult = result;
+    return NULL;
+}
+
+void zelDestroyPlayer(ZELPlayer *player) {
+    if (!player)
+        return;
+
+    free(player->frameEndMs);
+    free(player);
+}
+
+void zelPlayerReset(ZELPlayer *player, uint32_t nowMs) {
+    if (!player)
+        return;
+
+    player->lastNowMs = nowMs;
+    player->elapsedMs = 0;
+    player->hasFrame = 0;
+    player->lastFrameIndex = 0;
+    player->lastPosition = 0;
+    player->droppedFrames = 0;
+}
+
+/* First frame whose end lies after t; zero-length frames are never selected. */
+static uint32_t zelPlayerFindFrame(const ZELPlayer *player, uint32_t t) {
+    uint32_t low = 0;
+    uint32_t high = player->frameCount - 1;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (player->frameEndMs[mid] > t)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+ZELResult zelPlayerUpdate(ZELPlayer *player, uint32_t nowMs, ZELPlayerTick *outTick) {
+    if (!player || !outTick)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    /* Elapsed time is accumulated from deltas so the 32-bit clock may wrap. A clock that
+       steps backwards holds the current frame and counts on from the new reading. */
+    uint32_t delta = nowMs - player->lastNowMs;
+    if (delta <= (uint32_t)INT32_MAX)
+        player->elapsedMs += delta;
+    player->lastNowMs = nowMs;
+
+    uint32_t loopMs = player->frameEndMs[player->frameCount - 1];
+    uint64_t loop = player->elapsedMs / loopMs;
+    uint32_t t = (uint32_t)(player->elapsedMs % loopMs);
+    uint32_t frameIndex = zelPlayerFindFrame(player, t);
+    uint64_t position = loop * player->frameCount + frameIndex;
+
+    /* Late updates jump straight to the current frame; everything in between is dropped. A
+       single-frame animation never changes, so it has nothing to drop. */
+    uint32_t dropped = 0;
+    uint64_t expected = player->hasFrame ? player->lastPosition + 1 : 0;
+    if (position > expected && player->frameCount > 1) {
+        uint64_t skipped = position - expected;
+        dropped = skipped > UINT32_MAX ? UINT32_MAX : (uint32_t)skipped;
+    }
+
+    outTick->frameIndex = frameIndex;
+    outTick->frameChanged = !player->hasFrame || frameIndex != player->lastFrameIndex;
+    outTick->nextDeadlineMs = nowMs + (player->frameEndMs[frameIndex] - t);
+    outTick->framesDropped = dropped;
+
+    player->droppedFrames += dropped;
+    player->hasFrame = 1;
+    player->lastFrameIndex = frameIndex;
+    player->lastPosition = position;
+    return ZEL_OK;
+}
+
+uint32_t zelPlayerGetDroppedFrames(const ZELPlayer *player) {
+    return player ? player->droppedFrames : 0;
+}
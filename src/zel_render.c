@@ -0,0 +1,104 @@
+#include "zel_internal.h"
+
+static ZELResult zelCheckIndexImage(const uint8_t *src,
+                                    size_t srcStrideBytes,
+                                    uint16_t width,
+                                    uint16_t height,
+                                    uint16_t paletteCount) {
+    if (paletteCount > UINT8_MAX)
+        return ZEL_OK;
+
+    for (uint32_t row = 0; row < height; ++row) {
+        if (zelMaxIndex8(src + (size_t)row * srcStrideBytes, width) >= paletteCount)
+            return ZEL_ERR_CORRUPT_DATA;
+    }
+
+    return ZEL_OK;
+}
+
+ZELResult zelRenderIndex8Rgb565(const uint8_t *src,
+                                size_t srcStrideBytes,
+                                uint16_t width,
+                                uint16_t height,
+                                const uint16_t *palette,
+                                uint16_t paletteCount,
+                                uint16_t *dst,
+                                size_t dstStridePixels) {
+    if (!src || !palette || !dst || paletteCount == 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (srcStrideBytes < width || dstStridePixels < width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELResult result = zelCheckIndexImage(src, srcStrideBytes, width, height, paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    for (uint32_t row = 0; row < height; ++row) {
+        zelExpandRowRgb565(src + (size_t)row * srcStrideBytes,
+                           palette,
+                           dst + (size_t)row * dstStridePixels,
+                           width);
+    }
+
+    return ZEL_OK;
+}
+
+ZELResult zelRenderIndex8Argb8888(const uint8_t *src,
+                                  size_t srcStrideBytes,
+                                  uint16_t width,
+                                  uint16_t height,
+                                  const uint32_t *palette,
+                                  uint16_t paletteCount,
+                                  uint32_t *dst,
+                                  size_t dstStridePixels) {
+    if (!src || !palette || !dst || paletteCount == 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (srcStrideBytes < width || dstStridePixels < width)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    ZELResult result = zelCheckIndexImage(src, srcStrideBytes, width, height, paletteCount);
+    if (result != ZEL_OK)
+        return result;
+
+    for (uint32_t row = 0; row < height; ++row) {
+        zelExpandRow32(src + (size_t)row * srcStrideBytes,
+                       palette,
+                       dst + (size_t)row * dstStridePixels,
+                       width);
+    }
+
+    return ZEL_OK;
+}
+
+ZELResult zelConvertPaletteToArgb8888(const uint16_t *src,
+                                      uint16_t count,
+                                      ZELColorEncoding encoding,
+                                      uint32_t *dst) {
+    if (!src || !dst)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    if (!zelIsValidColorEncoding((uint8_t)encoding))
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    for (uint16_t i = 0; i < count; ++i) {
+        uint32_t alpha = 0xFFu;
+        uint16_t value = src[i];
+        if (encoding == ZEL_COLOR_ARGB4444_LE) {
+            alpha = (uint32_t)(value >> 12) * 0x11u;
+            value = zelArgb4444ToRgb565(value);
+        } else if (encoding == ZEL_COLOR_RGB565_BE) {
+            value = zelSwapRgb565(value);
+        }
+        uint32_t r = (value >> 11) & 0x1Fu;
+        uint32_t g = (value >> 5) & 0x3Fu;
+        uint32_t b = value & 0x1Fu;
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+        dst[i] = (alpha << 24) | (r << 16) | (g << 8) | b;
+    }
+
+    return ZEL_OK;
+}
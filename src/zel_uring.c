@@ -0,0 +1,396 @@
+/* mmap, syscall and posix_memalign need more than strict C11 exposes; the amalgamation defines
+   this too. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "zel_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ZEL_ENABLE_IO_URING) && defined(__linux__)
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define ZEL_URING_MAX_DEPTH 64u
+/* Reads start and end on this boundary so descriptors opened with O_DIRECT work too. */
+#define ZEL_URING_BLOCK 4096u
+
+typedef enum {
+    ZEL_SLOT_FREE = 0,
+    ZEL_SLOT_IN_FLIGHT,
+    ZEL_SLOT_READY,
+    ZEL_SLOT_CURRENT
+} ZELSlotState;
+
+typedef struct {
+    uint8_t *buffer;
+    ZELSlotState state;
+    uint32_t frameIndex;
+    /* Bytes between the block-aligned read offset and the start of the frame. */
+    size_t lead;
+    int32_t bytesRead;
+} ZELPrefetchSlot;
+
+struct ZELUringPrefetch {
+    const ZELContext *ctx;
+    int fd;
+    int ringFd;
+
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+    uint32_t *sqTail;
+    uint32_t sqMask;
+    uint32_t *sqArray;
+    uint32_t *cqHead;
+    uint32_t *cqTail;
+    uint32_t cqMask;
+    struct io_uring_cqe *cqes;
+
+    /* Slot buffers are registered with the ring when the memlock limit allows it. */
+    int fixedBuffers;
+    uint32_t depth;
+    uint32_t slotCount;
+    size_t slotCapacity;
+    uint32_t inFlight;
+    uint32_t unsubmitted;
+    ZELPrefetchSlot slots[ZEL_URING_MAX_DEPTH + 1u];
+};
+
+static size_t zelUringAlignUp(size_t value) {
+    return (value + ZEL_URING_BLOCK - 1u) & ~(size_t)(ZEL_URING_BLOCK - 1u);
+}
+
+static int zelUringFrameFits(const ZELContext *ctx, uint32_t frameIndex) {
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+    return fi->frameSize != 0 && zelRangeFits(fi->frameOffset, fi->frameSize, ctx->size);
+}
+
+static size_t zelUringReadLength(const ZELFrameIndexEntry *fi) {
+    return zelUringAlignUp((fi->frameOffset & (ZEL_URING_BLOCK - 1u)) + (size_t)fi->frameSize);
+}
+
+static int zelUringEnter(ZELUringPrefetch *prefetch, uint32_t minComplete) {
+    unsigned flags = minComplete ? IORING_ENTER_GETEVENTS : 0u;
+    for (;;) {
+        long submitted = syscall(__NR_io_uring_enter, prefetch->ringFd, prefetch->unsubmitted,
+                                 minComplete, flags, NULL, 0);
+        if (submitted >= 0) {
+            prefetch->unsubmitted -= (uint32_t)submitted;
+            return 0;
+        }
+        if (errno != EINTR)
+            return -1;
+    }
+}
+
+static void zelUringReap(ZELUringPrefetch *prefetch) {
+    uint32_t head = *prefetch->cqHead;
+    uint32_t tail = __atomic_load_n(prefetch->cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &prefetch->cqes[head & prefetch->cqMask];
+        ZELPrefetchSlot *slot = &prefetch->slots[cqe->user_data];
+        slot->bytesRead = cqe->res;
+        slot->state = ZEL_SLOT_READY;
+        prefetch->inFlight--;
+        head++;
+    }
+    __atomic_store_n(prefetch->cqHead, head, __ATOMIC_RELEASE);
+}
+
+/* Queues the read of one frame block into a free slot; zelUringEnter submits it. */
+static void zelUringQueue(ZELUringPrefetch *prefetch, uint32_t slotIndex, uint32_t frameIndex) {
+    const ZELFrameIndexEntry *fi = &prefetch->ctx->frameIndexTable[frameIndex];
+    ZELPrefetchSlot *slot = &prefetch->slots[slotIndex];
+    size_t lead = fi->frameOffset & (ZEL_URING_BLOCK - 1u);
+
+    uint32_t tail = *prefetch->sqTail;
+    uint32_t sqIndex = tail & prefetch->sqMask;
+    struct io_uring_sqe *sqe = &prefetch->sqes[sqIndex];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = prefetch->fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = prefetch->fd;
+    sqe->off = (uint64_t)(fi->frameOffset - lead);
+    sqe->addr = (uint64_t)(uintptr_t)slot->buffer;
+    sqe->len = (uint32_t)zelUringReadLength(fi);
+    sqe->buf_index = prefetch->fixedBuffers ? (uint16_t)slotIndex : 0u;
+    sqe->user_data = slotIndex;
+    prefetch->sqArray[sqIndex] = sqIndex;
+    __atomic_store_n(prefetch->sqTail, tail + 1u, __ATOMIC_RELEASE);
+
+    slot->state = ZEL_SLOT_IN_FLIGHT;
+    slot->frameIndex = frameIndex;
+    slot->lead = lead;
+    slot->bytesRead = 0;
+    prefetch->inFlight++;
+    prefetch->unsubmitted++;
+}
+
+static int zelUringFindSlot(const ZELUringPrefetch *prefetch, uint32_t frameIndex) {
+    for (uint32_t i = 0; i < prefetch->slotCount; ++i) {
+        if (prefetch->slots[i].state != ZEL_SLOT_FREE
+            && prefetch->slots[i].frameIndex == frameIndex) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int zelUringFreeSlot(const ZELUringPrefetch *prefetch) {
+    for (uint32_t i = 0; i < prefetch->slotCount; ++i) {
+        if (prefetch->slots[i].state == ZEL_SLOT_FREE)
+            return (int)i;
+    }
+    return -1;
+}
+
+/* Distance of frameIndex ahead of the decode position, wrapping at the loop point. */
+static uint32_t zelUringLookahead(const ZELUringPrefetch *prefetch,
+                                  uint32_t position,
+                                  uint32_t frameIndex) {
+    uint32_t frameCount = prefetch->ctx->header.frameCount;
+    return frameIndex >= position ? frameIndex - position : frameCount - position + frameIndex;
+}
+
+ZELResult zelPrefetchFrameBlock(ZELUringPrefetch *prefetch,
+                                uint32_t frameIndex,
+                                const uint8_t **outBytes) {
+    const ZELContext *ctx = prefetch->ctx;
+    if (!zelUringFrameFits(ctx, frameIndex))
+        return ZEL_ERR_CORRUPT_DATA;
+
+    zelUringReap(prefetch);
+
+    /* Ready blocks behind the position or beyond the queue were predicted wrongly (a seek or
+       a change of direction); their slots go back to the pool. */
+    for (uint32_t i = 0; i < prefetch->slotCount; ++i) {
+        ZELPrefetchSlot *slot = &prefetch->slots[i];
+        if (slot->state == ZEL_SLOT_CURRENT && slot->frameIndex != frameIndex)
+            slot->state = ZEL_SLOT_FREE;
+        if (slot->state == ZEL_SLOT_READY
+            && zelUringLookahead(prefetch, frameIndex, slot->frameIndex) > prefetch->depth) {
+            slot->state = ZEL_SLOT_FREE;
+        }
+    }
+
+    /* At most depth reads are in flight, so with depth + 1 slots one is free here. */
+    int target = zelUringFindSlot(prefetch, frameIndex);
+    if (target < 0) {
+        target = zelUringFreeSlot(prefetch);
+        if (target < 0)
+            return ZEL_ERR_INTERNAL;
+        zelUringQueue(prefetch, (uint32_t)target, frameIndex);
+    }
+
+    /* Refill the queue with the frames that follow, looping at the end. */
+    uint32_t frameCount = ctx->header.frameCount;
+    for (uint32_t ahead = 1; ahead <= prefetch->depth && ahead < frameCount; ++ahead) {
+        if (prefetch->inFlight >= prefetch->depth)
+            break;
+        uint32_t next = (uint32_t)(((uint64_t)frameIndex + ahead) % frameCount);
+        if (!zelUringFrameFits(ctx, next) || zelUringFindSlot(prefetch, next) >= 0)
+            continue;
+        int slotIndex = zelUringFreeSlot(prefetch);
+        if (slotIndex < 0)
+            break;
+        zelUringQueue(prefetch, (uint32_t)slotIndex, next);
+    }
+
+    ZELPrefetchSlot *slot = &prefetch->slots[target];
+    if (prefetch->unsubmitted && zelUringEnter(prefetch, 0) != 0)
+        return ZEL_ERR_IO;
+    while (slot->state == ZEL_SLOT_IN_FLIGHT) {
+        if (zelUringEnter(prefetch, 1) != 0)
+            return ZEL_ERR_IO;
+        zelUringReap(prefetch);
+    }
+
+    /* Only the last block of the file may come back short, and never inside the frame. */
+    const ZELFrameIndexEntry *fi = &ctx->frameIndexTable[frameIndex];
+    if (slot->bytesRead < 0 || (size_t)slot->bytesRead < slot->lead + fi->frameSize) {
+        slot->state = ZEL_SLOT_FREE;
+        return ZEL_ERR_IO;
+    }
+
+    slot->state = ZEL_SLOT_CURRENT;
+    *outBytes = slot->buffer + slot->lead;
+    return ZEL_OK;
+}
+
+void zelDestroyUringPrefetch(ZELUringPrefetch *prefetch) {
+    if (!prefetch)
+        return;
+
+    /* The kernel may still be writing into the slot buffers, so wait for every read. */
+    if (prefetch->ringFd >= 0) {
+        while (prefetch->inFlight) {
+            if (zelUringEnter(prefetch, 1) != 0)
+                break;
+            zelUringReap(prefetch);
+        }
+    }
+
+    if (prefetch->sqes)
+        munmap(prefetch->sqes, prefetch->sqesSize);
+    if (prefetch->cqRing && prefetch->cqRing != prefetch->sqRing)
+        munmap(prefetch->cqRing, prefetch->cqRingSize);
+    if (prefetch->sqRing)
+        munmap(prefetch->sqRing, prefetch->sqRingSize);
+    if (prefetch->ringFd >= 0)
+        close(prefetch->ringFd);
+    for (uint32_t i = 0; i < prefetch->slotCount; ++i)
+        free(prefetch->slots[i].buffer);
+    free(prefetch);
+}
+
+static ZELResult zelUringMapRings(ZELUringPrefetch *prefetch, const struct io_uring_params *p) {
+    prefetch->sqRingSize = p->sq_off.array + p->sq_entries * sizeof(uint32_t);
+    prefetch->cqRingSize = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    int singleMap = (p->features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap && prefetch->cqRingSize > prefetch->sqRingSize)
+        prefetch->sqRingSize = prefetch->cqRingSize;
+
+    void *sqRing = mmap(NULL, prefetch->sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, prefetch->ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED)
+        return ZEL_ERR_IO;
+    prefetch->sqRing = sqRing;
+
+    void *cqRing = sqRing;
+    if (!singleMap) {
+        cqRing = mmap(NULL, prefetch->cqRingSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, prefetch->ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED)
+            return ZEL_ERR_IO;
+    }
+    prefetch->cqRing = cqRing;
+
+    prefetch->sqesSize = p->sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, prefetch->sqesSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, prefetch->ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        return ZEL_ERR_IO;
+    prefetch->sqes = (struct io_uring_sqe *)sqes;
+
+    uint8_t *sq = (uint8_t *)sqRing;
+    uint8_t *cq = (uint8_t *)cqRing;
+    prefetch->sqTail = (uint32_t *)(sq + p->sq_off.tail);
+    prefetch->sqMask = *(const uint32_t *)(sq + p->sq_off.ring_mask);
+    prefetch->sqArray = (uint32_t *)(sq + p->sq_off.array);
+    prefetch->cqHead = (uint32_t *)(cq + p->cq_off.head);
+    prefetch->cqTail = (uint32_t *)(cq + p->cq_off.tail);
+    prefetch->cqMask = *(const uint32_t *)(cq + p->cq_off.ring_mask);
+    prefetch->cqes = (struct io_uring_cqe *)(cq + p->cq_off.cqes);
+    return ZEL_OK;
+}
+
+ZELResult zelEnableUringPrefetch(ZELContext *ctx, int fd, uint32_t queueDepth) {
+    if (!ctx || ctx->data || queueDepth > ZEL_URING_MAX_DEPTH)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    zelDestroyUringPrefetch(ctx->prefetch);
+    ctx->prefetch = NULL;
+    if (queueDepth == 0)
+        return ZEL_OK;
+
+    if (fd < 0)
+        fd = zelStreamDescriptor(&ctx->stream);
+    if (fd < 0)
+        return ZEL_ERR_INVALID_ARGUMENT;
+
+    size_t capacity = 0;
+    for (uint32_t i = 0; i < ctx->header.frameCount; ++i) {
+        if (!zelUringFrameFits(ctx, i))
+            continue;
+        size_t length = zelUringReadLength(&ctx->frameIndexTable[i]);
+        if (length > capacity)
+            capacity = length;
+    }
+    if (capacity == 0)
+        return ZEL_ERR_CORRUPT_DATA;
+    if (capacity > UINT32_MAX)
+        return ZEL_ERR_UNSUPPORTED_FORMAT;
+
+    ZELUringPrefetch *prefetch = (ZELUringPrefetch *)calloc(1, sizeof(ZELUringPrefetch));
+    if (!prefetch)
+        return ZEL_ERR_OUT_OF_MEMORY;
+    prefetch->ctx = ctx;
+    prefetch->fd = fd;
+    prefetch->ringFd = -1;
+    prefetch->depth = queueDepth;
+    prefetch->slotCount = queueDepth + 1u;
+    prefetch->slotCapacity = capacity;
+
+    ZELResult result = ZEL_OK;
+    struct iovec iov[ZEL_URING_MAX_DEPTH + 1u];
+    for (uint32_t i = 0; i < prefetch->slotCount; ++i) {
+        void *buffer = NULL;
+        if (posix_memalign(&buffer, ZEL_URING_BLOCK, capacity) != 0) {
+            result = ZEL_ERR_OUT_OF_MEMORY;
+            goto fail;
+        }
+        prefetch->slots[i].buffer = (uint8_t *)buffer;
+        iov[i].iov_base = buffer;
+        iov[i].iov_len = capacity;
+    }
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    long ringFd = syscall(__NR_io_uring_setup, prefetch->slotCount, &params);
+    if (ringFd < 0) {
+        /* ENOSYS, or io_uring disabled by the kernel or a seccomp policy. */
+        result = ZEL_ERR_UNSUPPORTED_FORMAT;
+        goto fail;
+    }
+    prefetch->ringFd = (int)ringFd;
+
+    result = zelUringMapRings(prefetch, &params);
+    if (result != ZEL_OK)
+        goto fail;
+
+    /* Registration pins the buffers, which RLIMIT_MEMLOCK may refuse; plain reads still work. */
+    prefetch->fixedBuffers = syscall(__NR_io_uring_register, prefetch->ringFd,
+                                     IORING_REGISTER_BUFFERS, iov, prefetch->slotCount)
+                             == 0;
+
+    ctx->prefetch = prefetch;
+    return ZEL_OK;
+
+fail:
+    zelDestroyUringPrefetch(prefetch);
+    return result;
+}
+
+#else
+
+ZELResult zelEnableUringPrefetch(ZELContext *ctx, int fd, uint32_t queueDepth) {
+    (void)fd;
+    if (!ctx)
+        return ZEL_ERR_INVALID_ARGUMENT;
+    return queueDepth == 0 ? ZEL_OK : ZEL_ERR_UNSUPPORTED_FORMAT;
+}
+
+ZELResult zelPrefetchFrameBlock(ZELUringPrefetch *prefetch,
+                                uint32_t frameIndex,
+                                const uint8_t **outBytes) {
+    (void)prefetch;
+    (void)frameIndex;
+    (void)outBytes;
+    return ZEL_ERR_UNSUPPORTED_FORMAT;
+}
+
+void zelDestroyUringPrefetch(ZELUringPrefetch *prefetch) {
+    (void)prefetch;
+}
+
+#endif
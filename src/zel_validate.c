@@ -0,0 +1,101 @@
+#include "zel_internal.h"
+
+#include <stdlib.h>
+
+typedef struct {
+    const ZELContext *ctx;
+    ZELScratch *scratch;
+    uint32_t scratchCount;
+    ZELResult *frameResults;
+    uint32_t *frameZones;
+} ZELValidateTaskData;
+
+static void zelRunValidateFrame(void *taskData, uint32_t taskIndex, uint32_t workerIndex) {
+    ZELValidateTaskData *validation = (ZELValidateTaskData *)taskData;
+
+    if (workerIndex >= validation->scratchCount) {
+        validation->frameResults[taskIndex] = ZEL_ERR_INTERNAL;
+        validation->frameZones[taskIndex] = ZEL_INDEX_NONE;
+        return;
+    }
+
+    validation->frameResults[taskIndex] =
+            zelValidateFrameWithScratch(validation->ctx,
+                                        taskIndex,
+                                        &validation->scratch[workerIndex],
+                                        &validation->frameZones[taskIndex]);
+}
+
+ZELResult zelValidate(const ZELContext *ctx,
+                      const ZELWorkerPool *pool,
+                      ZELValidationReport *outReport) {
+    ZELValidationReport report;
+    report.result = ZEL_OK;
+    report.frameIndex = ZEL_INDEX_NONE;
+    report.zoneIndex = ZEL_INDEX_NONE;
+
+    if (!ctx) {
+        report.result = ZEL_ERR_INVALID_ARGUMENT;
+        goto done;
+    }
+
+    uint32_t frameCount = ctx->header.frameCount;
+    if (frameCount == 0) {
+        report.result = ZEL_ERR_CORRUPT_DATA;
+        goto done;
+    }
+
+    if (ctx->globalPaletteRaw) {
+        const uint16_t *entries = NULL;
+        uint16_t count = 0;
+        report.result = zelResolveGlobalPalette(ctx, &entries, &count);
+        if (report.result != ZEL_OK)
+            goto done;
+    }
+
+    int parallel = (pool && pool->run && pool->workerCount > 0);
+    uint32_t scratchCount = parallel ? pool->workerCount : 1;
+
+    ZELValidateTaskData validation;
+    validation.ctx = ctx;
+    validation.scratchCount = scratchCount;
+    validation.scratch = (ZELScratch *)calloc(scratchCount, sizeof(ZELScratch));
+    validation.frameResults = (ZELResult *)malloc((size_t)frameCount * sizeof(ZELResult));
+    validation.frameZones = (uint32_t *)malloc((size_t)frameCount * sizeof(uint32_t));
+
+    if (!validation.scratch || !validation.frameResults || !validation.frameZones) {
+        report.result = ZEL_ERR_OUT_OF_MEMORY;
+    } else {
+        if (parallel) {
+            pool->run(pool->userData, zelRunValidateFrame, &validation, frameCount);
+        } else {
+            for (uint32_t i = 0; i < frameCount; ++i)
+                zelRunValidateFrame(&validation, i, 0);
+        }
+
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            if (validation.frameResults[i] != ZEL_OK) {
+                report.result = validation.frameResults[i];
+                report.frameIndex = i;
+                report.zoneIndex = validation.frameZones[i];
+                break;
+            }
+        }
+    }
+
+    if (validation.scratch) {
+        for (uint32_t i = 0; i < scratchCount; ++i)
+            zelReleaseScratch(&validation.scratch[i]);
+    }
+    free(validation.scratch);
+    free(validation.frameResults);
+    free(validation.frameZones);
+
+    if (report.result == ZEL_OK)
+        ((ZELContext *)ctx)->validated = 1;
+
+done:
+    if (outReport)
+        *outReport = report;
+    return report.result;
+}
@@ -1,4 +1,5 @@
 #include "fixtures/simple_zel_file.h"
+#include "lz4/lz4.h"
 #include "zel/zel.h"
 
 #include <assert.h>
@@ -40,6 +41,31 @@ static size_t test_memory_stream_read(void *userData, size_t offset, void *dst,
     return size;
 }
 
+typedef struct {
+    uint32_t runs;
+    uint32_t tasksRun;
+} TestWorkerPool;
+
+/* Runs tasks in reverse order and spreads them over the declared workers so that order and
+   scratch-sharing assumptions surface in tests. */
+static void test_worker_pool_run(void *userData, ZELTaskFunc task, void *taskData, uint32_t count) {
+    TestWorkerPool *pool = (TestWorkerPool *)userData;
+    pool->runs++;
+    for (uint32_t i = count; i > 0; --i) {
+        task(taskData, i - 1, (i - 1) % 3);
+        pool->tasksRun++;
+    }
+}
+
+static ZELWorkerPool make_test_worker_pool(TestWorkerPool *state) {
+    memset(state, 0, sizeof(*state));
+    ZELWorkerPool pool;
+    pool.run = test_worker_pool_run;
+    pool.userData = state;
+    pool.workerCount = 3;
+    return pool;
+}
+
 static const uint8_t kSimpleFramePattern[8] = {0, 1, 0, 1, 1, 0, 1, 0};
 
 static void build_expected_rgb_frame(uint16_t *dst, const uint16_t palette[2]) {
@@ -378,6 +404,146 @@ static uint8_t *buildSimpleZelThreeFrames(size_t *outSize) {
     return buf;
 }
 
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint16_t zoneWidth;
+    uint16_t zoneHeight;
+    uint32_t frameCount;
+    const uint8_t *pixels; /* frameCount * width * height indices */
+    const uint16_t *palette;
+    uint16_t paletteCount;
+    ZELCompressionType compression;
+    const uint8_t *frameFlags; /* optional; every frame is a keyframe when NULL */
+} TestAnimationSpec;
+
+/* Builds a multi-frame ZEL file with a global LE palette and NONE or LZ4 zone chunks. */
+static uint8_t *buildZelAnimation(const TestAnimationSpec *spec, size_t *outSize) {
+    const uint32_t zonesPerRow = spec->width / spec->zoneWidth;
+    const uint32_t zoneCount = zonesPerRow * (spec->height / spec->zoneHeight);
+    const size_t zoneBytes = (size_t)spec->zoneWidth * spec->zoneHeight;
+    const size_t framePixels = (size_t)spec->width * spec->height;
+    const size_t paletteBytes = (size_t)spec->paletteCount * sizeof(uint16_t);
+    const size_t indexOffset =
+            ZEL_FILE_HEADER_DISK_SIZE + ZEL_PALETTE_HEADER_DISK_SIZE + paletteBytes;
+    const size_t capacity = indexOffset + spec->frameCount * ZEL_FRAME_INDEX_ENTRY_DISK_SIZE
+                            + spec->frameCount
+                                      * (ZEL_FRAME_HEADER_DISK_SIZE
+                                         + zoneCount * (4 + (size_t)LZ4_COMPRESSBOUND(zoneBytes)));
+
+    uint8_t *buf = (uint8_t *)calloc(1, capacity);
+    uint8_t *zone = (uint8_t *)malloc(zoneBytes);
+    assert(buf && zone);
+
+    memcpy(buf, "ZEL0", 4);
+    write_le16(buf + 4, 1);
+    write_le16(buf + 6, ZEL_FILE_HEADER_DISK_SIZE);
+    write_le16(buf + 8, spec->width);
+    write_le16(buf + 0x0A, spec->height);
+    write_le16(buf + 0x0C, spec->zoneWidth);
+    write_le16(buf + 0x0E, spec->zoneHeight);
+    buf[0x10] = ZEL_COLOR_FORMAT_INDEXED8;
+    buf[0x11] = 0x01u | 0x04u;
+    write_le32(buf + 0x12, spec->frameCount);
+    write_le16(buf + 0x16, 10);
+
+    uint8_t *ph = buf + ZEL_FILE_HEADER_DISK_SIZE;
+    ph[0] = ZEL_PALETTE_TYPE_GLOBAL;
+    ph[1] = ZEL_PALETTE_HEADER_DISK_SIZE;
+    write_le16(ph + 2, spec->paletteCount);
+    ph[4] = ZEL_COLOR_RGB565_LE;
+    write_palette_bytes(ph + ZEL_PALETTE_HEADER_DISK_SIZE,
+                        spec->palette,
+                        spec->paletteCount,
+                        ZEL_COLOR_RGB565_LE);
+
+    size_t off = indexOffset + spec->frameCount * ZEL_FRAME_INDEX_ENTRY_DISK_SIZE;
+    for (uint32_t f = 0; f < spec->frameCount; ++f) {
+        const uint8_t flags = spec->frameFlags ? spec->frameFlags[f] : 0x01u;
+        const uint8_t *pixels = spec->pixels + f * framePixels;
+        const size_t frameOffset = off;
+
+        uint8_t *frh = buf + off;
+        frh[0] = 1;
+        frh[1] = ZEL_FRAME_HEADER_DISK_SIZE;
+        frh[2] = flags;
+        write_le16(frh + 3, (uint16_t)zoneCount);
+        frh[5] = (uint8_t)spec->compression;
+        off += ZEL_FRAME_HEADER_DISK_SIZE;
+
+        for (uint32_t z = 0; z < zoneCount; ++z) {
+            const uint32_t zoneX = (z % zonesPerRow) * spec->zoneWidth;
+            const uint32_t zoneY = (z / zonesPerRow) * spec->zoneHeight;
+            for (uint16_t row = 0; row < spec->zoneHeight; ++row)
+                memcpy(zone + (size_t)row * spec->zoneWidth,
+                       pixels + (size_t)(zoneY + row) * spec->width + zoneX,
+                       spec->zoneWidth);
+
+            uint32_t chunkSize = (uint32_t)zoneBytes;
+            if (spec->compression == ZEL_COMPRESSION_LZ4) {
+                int packed = LZ4_compress_default((const char *)zone,
+                                                  (char *)buf + off + 4,
+                                                  (int)zoneBytes,
+                                                  LZ4_COMPRESSBOUND((int)zoneBytes));
+                assert(packed > 0);
+                chunkSize = (uint32_t)packed;
+            } else {
+                memcpy(buf + off + 4, zone, zoneBytes);
+            }
+            write_le32(buf + off, chunkSize);
+            off += 4 + chunkSize;
+        }
+
+        uint8_t *fie = buf + indexOffset + f * ZEL_FRAME_INDEX_ENTRY_DISK_SIZE;
+        write_le32(fie + 0, (uint32_t)frameOffset);
+        write_le32(fie + 4, (uint32_t)(off - frameOffset));
+        fie[8] = flags;
+    }
+
+    free(zone);
+    if (outSize)
+        *outSize = off;
+    return buf;
+}
+
+static void fill_test_pixels(uint8_t *pixels, size_t count, uint32_t seed, uint16_t paletteCount) {
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        /* Short runs keep LZ4 chunks compressible. */
+        pixels[i] = (uint8_t)(((seed >> 16) % paletteCount) & ((i & 4) ? 0xFFu : 0x00u));
+    }
+}
+
+static void expand_test_pixels(uint16_t *dst,
+                               const uint8_t *pixels,
+                               size_t count,
+                               const uint16_t *palette) {
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = palette[pixels[i]];
+}
+
+static uint32_t read_le32(const uint8_t *src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16)
+           | ((uint32_t)src[3] << 24);
+}
+
+/* Returns the payload offset of a zone chunk in a file made by buildZelAnimation. */
+static size_t locate_test_chunk(const uint8_t *data,
+                                uint16_t paletteCount,
+                                uint32_t frameIndex,
+                                uint32_t zoneIndex,
+                                uint32_t *outChunkSize) {
+    size_t indexOffset = ZEL_FILE_HEADER_DISK_SIZE + ZEL_PALETTE_HEADER_DISK_SIZE
+                         + (size_t)paletteCount * sizeof(uint16_t);
+    size_t off = read_le32(data + indexOffset + frameIndex * ZEL_FRAME_INDEX_ENTRY_DISK_SIZE)
+                 + ZEL_FRAME_HEADER_DISK_SIZE;
+    for (uint32_t z = 0; z < zoneIndex; ++z)
+        off += 4 + read_le32(data + off);
+    if (outChunkSize)
+        *outChunkSize = read_le32(data + off);
+    return off + 4;
+}
+
 /* === Tests === */
 
 static void test_open_and_basic_getters(void) {
@@ -637,6 +803,1817 @@ static void test_zone_decoders(void) {
     free(data);
 }
 
+static void test_decode_batch_rgb565(void) {
+    size_t sizeA = 0;
+    uint8_t *dataA = buildSimpleZelSingleFrame(&sizeA);
+    size_t sizeB = 0;
+    static const uint16_t paletteB[2] = {0x00F8, 0x1234};
+    uint8_t *dataB = buildSimpleZelSingleFrameWithZonesCustom(2,
+                                                              1,
+                                                              paletteB,
+                                                              2,
+                                                              ZEL_COLOR_RGB565_LE,
+                                                              &sizeB);
+
+    ZELResult res;
+    ZELContext *ctxA = zelOpenMemory(dataA, sizeA, &res);
+    assert(ctxA && res == ZEL_OK);
+
+    TestMemoryStream memStream = {dataB, sizeB};
+    ZELInputStream stream;
+    stream.read = test_memory_stream_read;
+    stream.close = NULL;
+    stream.userData = &memStream;
+    stream.size = sizeB;
+    ZELContext *ctxB = zelOpenStream(&stream, &res);
+    assert(ctxB && res == ZEL_OK);
+    zelSetOutputColorEncoding(ctxB, ZEL_COLOR_RGB565_BE);
+
+    uint16_t expectedA[8];
+    static const uint16_t paletteA[2] = {0x0000, 0xFFFF};
+    build_expected_rgb_frame(expectedA, paletteA);
+    uint16_t expectedB[8];
+    uint16_t swappedB[2] = {swap_u16(paletteB[0]), swap_u16(paletteB[1])};
+    build_expected_rgb_frame(expectedB, swappedB);
+
+    enum { JOBS = 5 };
+    uint16_t frames[JOBS][8];
+    ZELDecodeJob jobs[JOBS];
+    for (int pass = 0; pass < 2; ++pass) {
+        memset(frames, 0, sizeof(frames));
+        for (int i = 0; i < JOBS; ++i) {
+            jobs[i].ctx = (i % 2) ? ctxB : ctxA;
+            jobs[i].frameIndex = 0;
+            jobs[i].dst = frames[i];
+            jobs[i].dstStridePixels = 4;
+            jobs[i].result = ZEL_ERR_INTERNAL;
+        }
+
+        TestWorkerPool poolState;
+        ZELWorkerPool pool = make_test_worker_pool(&poolState);
+        res = zelDecodeBatchRgb565(jobs, JOBS, pass ? &pool : NULL);
+        assert(res == ZEL_OK);
+        assert(poolState.runs == (pass ? 1u : 0u));
+
+        for (int i = 0; i < JOBS; ++i) {
+            assert(jobs[i].result == ZEL_OK);
+            const uint16_t *expected = (i % 2) ? expectedB : expectedA;
+            assert(memcmp(frames[i], expected, sizeof(expectedA)) == 0);
+        }
+    }
+
+    jobs[1].frameIndex = 3;
+    jobs[3].dstStridePixels = 2;
+    res = zelDecodeBatchRgb565(jobs, JOBS, NULL);
+    assert(res == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(jobs[0].result == ZEL_OK);
+    assert(jobs[1].result == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(jobs[3].result == ZEL_ERR_INVALID_ARGUMENT);
+    assert(jobs[4].result == ZEL_OK);
+
+    assert(zelDecodeBatchRgb565(NULL, 0, NULL) == ZEL_OK);
+    assert(zelDecodeBatchRgb565(NULL, 1, NULL) == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(ctxB);
+    zelClose(ctxA);
+    free(dataB);
+    free(dataA);
+}
+
+typedef struct {
+    const uint16_t *expected;
+    size_t framePixels;
+    uint32_t seen;
+} TestFrameSinkState;
+
+static ZELResult test_frame_sink(void *userData,
+                                 uint32_t frameIndex,
+                                 const uint16_t *pixels,
+                                 size_t stridePixels,
+                                 uint32_t workerIndex) {
+    TestFrameSinkState *state = (TestFrameSinkState *)userData;
+    assert(workerIndex < 3);
+    assert(stridePixels * 4 == state->framePixels);
+    assert(memcmp(pixels,
+                  state->expected + frameIndex * state->framePixels,
+                  state->framePixels * sizeof(uint16_t))
+           == 0);
+    state->seen |= 1u << frameIndex;
+    return ZEL_OK;
+}
+
+static void test_decode_frame_range(void) {
+    enum { W = 8, H = 4, FRAMES = 6, PIXELS = W * H };
+    static const uint16_t palette[4] = {0x0000, 0xF800, 0x07E0, 0x001F};
+    static const uint8_t flags[FRAMES] = {0x01, 0x04, 0x04, 0x01, 0x00, 0x04};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 7, 4);
+
+    uint16_t expected[FRAMES * PIXELS];
+    expand_test_pixels(expected, pixels, FRAMES * PIXELS, palette);
+
+    TestAnimationSpec spec = {W, H, 4, 2, FRAMES, pixels, palette, 4, ZEL_COMPRESSION_LZ4, flags};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    TestWorkerPool poolState;
+    ZELWorkerPool pool = make_test_worker_pool(&poolState);
+
+    uint16_t frames[FRAMES * PIXELS];
+    for (int pass = 0; pass < 2; ++pass) {
+        memset(frames, 0, sizeof(frames));
+        res = zelDecodeFrameRangeRgb565(ctx, 0, FRAMES, frames, W, PIXELS, pass ? &pool : NULL);
+        assert(res == ZEL_OK);
+        assert(memcmp(frames, expected, sizeof(expected)) == 0);
+    }
+    /* Frames 0-2 and 3-5 each form one keyframe-led group, frame 4 starts its own. */
+    assert(poolState.runs == 1 && poolState.tasksRun == 3);
+
+    memset(frames, 0, sizeof(frames));
+    res = zelDecodeFrameRangeRgb565(ctx, 2, 3, frames, W, PIXELS, &pool);
+    assert(res == ZEL_OK);
+    assert(memcmp(frames, expected + 2 * PIXELS, 3 * PIXELS * sizeof(uint16_t)) == 0);
+
+    assert(zelDecodeFrameRangeRgb565(ctx, 4, 3, frames, W, PIXELS, NULL) == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(zelDecodeFrameRangeRgb565(ctx, 0, 2, frames, W, PIXELS - 1, NULL)
+           == ZEL_ERR_INVALID_ARGUMENT);
+    /* A stride whose frame size wraps to 0, and a pitch that would place frame 2 past the
+       address space, are both rejected before decoding. */
+    assert(zelDecodeFrameRangeRgb565(ctx, 0, 2, frames, SIZE_MAX / H + 1, PIXELS, NULL)
+           == ZEL_ERR_INVALID_ARGUMENT);
+    assert(zelDecodeFrameRangeRgb565(ctx, 0, 3, frames, W, SIZE_MAX / 2, NULL)
+           == ZEL_ERR_INVALID_ARGUMENT);
+
+    TestFrameSinkState sinkState = {expected, PIXELS, 0};
+    res = zelDecodeFrameRangeRgb565ToSink(ctx, 0, FRAMES, test_frame_sink, &sinkState, &pool);
+    assert(res == ZEL_OK);
+    assert(sinkState.seen == (1u << FRAMES) - 1u);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_validate(void) {
+    enum { W = 8, H = 4, FRAMES = 4, PIXELS = W * H };
+    static const uint16_t palette[4] = {0x0000, 0xF800, 0x07E0, 0x001F};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 11, 4);
+
+    TestAnimationSpec spec = {W, H, 4, 2, FRAMES, pixels, palette, 4, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+
+    TestWorkerPool poolState;
+    ZELWorkerPool pool = make_test_worker_pool(&poolState);
+
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+    ZELValidationReport report;
+    res = zelValidate(ctx, &pool, &report);
+    assert(res == ZEL_OK && report.result == ZEL_OK);
+    assert(report.frameIndex == ZEL_INDEX_NONE && report.zoneIndex == ZEL_INDEX_NONE);
+    assert(poolState.tasksRun == FRAMES);
+    zelClose(ctx);
+
+    /* Garble the LZ4 payload of frame 2, zone 1. */
+    uint32_t chunkSize = 0;
+    size_t payload = locate_test_chunk(data, 4, 2, 1, &chunkSize);
+    uint8_t *broken = (uint8_t *)malloc(size);
+    assert(broken);
+    memcpy(broken, data, size);
+    memset(broken + payload, 0xFF, chunkSize);
+    ctx = zelOpenMemory(broken, size, &res);
+    assert(ctx && res == ZEL_OK);
+    res = zelValidate(ctx, NULL, &report);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    assert(report.frameIndex == 2 && report.zoneIndex == 1);
+    res = zelValidate(ctx, &pool, &report);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    assert(report.frameIndex == 2 && report.zoneIndex == 1);
+    zelClose(ctx);
+    free(broken);
+    free(data);
+
+    /* Out-of-palette index in an uncompressed zone. */
+    spec.compression = ZEL_COMPRESSION_NONE;
+    data = buildZelAnimation(&spec, &size);
+    payload = locate_test_chunk(data, 4, 3, 3, NULL);
+    data[payload + 5] = 4;
+    ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+    res = zelValidate(ctx, &pool, &report);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    assert(report.frameIndex == 3 && report.zoneIndex == 3);
+    zelClose(ctx);
+    free(data);
+
+    assert(zelValidate(NULL, NULL, &report) == ZEL_ERR_INVALID_ARGUMENT);
+}
+
+static void test_trusted_mode(void) {
+    enum { W = 8, H = 4, FRAMES = 3, PIXELS = W * H };
+    static const uint16_t palette[4] = {0x0000, 0xF800, 0x07E0, 0x001F};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 5, 4);
+    uint16_t expected[FRAMES * PIXELS];
+    expand_test_pixels(expected, pixels, FRAMES * PIXELS, palette);
+
+    for (int compression = 0; compression < 2; ++compression) {
+        TestAnimationSpec spec = {W,
+                                  H,
+                                  2,
+                                  2,
+                                  FRAMES,
+                                  pixels,
+                                  palette,
+                                  4,
+                                  compression ? ZEL_COMPRESSION_LZ4 : ZEL_COMPRESSION_NONE,
+                                  NULL};
+        size_t size = 0;
+        uint8_t *data = buildZelAnimation(&spec, &size);
+
+        TestMemoryStream memStream = {data, size};
+        ZELInputStream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.read = test_memory_stream_read;
+        stream.userData = &memStream;
+        stream.size = size;
+
+        ZELResult res;
+        ZELContext *contexts[2];
+        contexts[0] = zelOpenMemory(data, size, &res);
+        assert(contexts[0] && res == ZEL_OK);
+        contexts[1] = zelOpenStream(&stream, &res);
+        assert(contexts[1] && res == ZEL_OK);
+
+        for (int c = 0; c < 2; ++c) {
+            ZELContext *ctx = contexts[c];
+            assert(zelSetTrustedMode(ctx, 1) == ZEL_ERR_INVALID_ARGUMENT);
+            assert(zelIsTrustedMode(ctx) == 0);
+            assert(zelValidate(ctx, NULL, NULL) == ZEL_OK);
+            assert(zelSetTrustedMode(ctx, 1) == ZEL_OK);
+            assert(zelIsTrustedMode(ctx) == 1);
+
+            uint16_t frame[PIXELS];
+            uint8_t indices[PIXELS];
+            for (uint32_t f = 0; f < FRAMES; ++f) {
+                memset(frame, 0, sizeof(frame));
+                res = zelDecodeFrameRgb565(ctx, f, frame, W);
+                assert(res == ZEL_OK);
+                assert(memcmp(frame, expected + f * PIXELS, sizeof(frame)) == 0);
+
+                res = zelDecodeFrameIndex8(ctx, f, indices, W);
+                assert(res == ZEL_OK);
+                assert(memcmp(indices, pixels + f * PIXELS, sizeof(indices)) == 0);
+            }
+
+            assert(zelSetTrustedMode(ctx, 0) == ZEL_OK);
+            assert(zelIsTrustedMode(ctx) == 0);
+            zelClose(ctx);
+        }
+        free(data);
+    }
+}
+
+typedef struct {
+    uint32_t calls;
+} TestPaletteTransform;
+
+static void test_invert_palette(void *userData,
+                                uint16_t *entries,
+                                uint16_t count,
+                                ZELColorEncoding encoding) {
+    TestPaletteTransform *state = (TestPaletteTransform *)userData;
+    (void)encoding;
+    state->calls++;
+    for (uint16_t i = 0; i < count; ++i)
+        entries[i] = (uint16_t)~entries[i];
+}
+
+static void test_palette_transform(void) {
+    size_t size = 0;
+    static const uint16_t palette[2] = {0xF800, 0x07FF};
+    uint8_t *data = buildSimpleZelSingleFrameWithZonesCustom(4,
+                                                             2,
+                                                             palette,
+                                                             2,
+                                                             ZEL_COLOR_RGB565_LE,
+                                                             &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    TestPaletteTransform state = {0};
+    zelSetPaletteTransform(ctx, test_invert_palette, &state);
+
+    uint16_t expected[8];
+    uint16_t inverted[2] = {(uint16_t)~palette[0], (uint16_t)~palette[1]};
+    build_expected_rgb_frame(expected, inverted);
+
+    uint16_t frame[8];
+    for (int i = 0; i < 3; ++i) {
+        res = zelDecodeFrameRgb565(ctx, 0, frame, 4);
+        assert(res == ZEL_OK);
+        assert(memcmp(frame, expected, sizeof(expected)) == 0);
+    }
+    assert(state.calls == 1);
+
+    /* A new output encoding re-resolves the palette and re-applies the transform. */
+    zelSetOutputColorEncoding(ctx, ZEL_COLOR_RGB565_BE);
+    res = zelDecodeFrameRgb565(ctx, 0, frame, 4);
+    assert(res == ZEL_OK);
+    assert(state.calls == 2);
+    const uint16_t invertedBE = (uint16_t)~swap_u16(palette[1]);
+    assert(frame[1] == invertedBE);
+    zelSetOutputColorEncoding(ctx, ZEL_COLOR_RGB565_LE);
+
+    /* Half brightness, red tint removed, identity gamma. */
+    uint8_t gamma[256];
+    for (int i = 0; i < 256; ++i)
+        gamma[i] = (uint8_t)i;
+    ZELPaletteAdjust adjust = {128, 0, 256, 256, gamma};
+    assert(zelSetPaletteAdjust(ctx, &adjust) == ZEL_OK);
+    res = zelDecodeFrameRgb565(ctx, 0, frame, 4);
+    assert(res == ZEL_OK);
+    assert(frame[0] == 0x0000);
+    assert(frame[1] == ((32u << 5) | 16u));
+
+    ZELPaletteAdjust identity = {256, 256, 256, 256, NULL};
+    assert(zelSetPaletteAdjust(ctx, &identity) == ZEL_OK);
+    const uint16_t *pal = NULL;
+    uint16_t palCount = 0;
+    res = zelGetGlobalPalette(ctx, &pal, &palCount);
+    assert(res == ZEL_OK && pal[0] == palette[0] && pal[1] == palette[1]);
+
+    assert(zelSetPaletteAdjust(ctx, NULL) == ZEL_OK);
+    build_expected_rgb_frame(expected, palette);
+    res = zelDecodeFrameRgb565(ctx, 0, frame, 4);
+    assert(res == ZEL_OK);
+    assert(memcmp(frame, expected, sizeof(expected)) == 0);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_render_index8_with_palette(void) {
+    enum { W = 8, H = 4, PIXELS = W * H };
+    static const uint16_t palette[4] = {0x0000, 0xF800, 0x07E0, 0x001F};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 3, 4);
+
+    TestAnimationSpec spec = {W, H, 4, 2, 1, pixels, palette, 4, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    uint8_t indices[PIXELS];
+    res = zelDecodeFrameIndex8(ctx, 0, indices, W);
+    assert(res == ZEL_OK);
+
+    /* Rotate the palette without touching the indices. */
+    for (uint16_t shift = 0; shift < 4; ++shift) {
+        uint16_t cycled[4];
+        for (uint16_t i = 0; i < 4; ++i)
+            cycled[i] = palette[(i + shift) % 4];
+
+        uint16_t expected[PIXELS];
+        expand_test_pixels(expected, pixels, PIXELS, cycled);
+
+        uint16_t rgb[PIXELS + 2];
+        memset(rgb, 0xAB, sizeof(rgb));
+        res = zelRenderIndex8Rgb565(indices, W, W, H, cycled, 4, rgb + 1, W);
+        assert(res == ZEL_OK);
+        assert(memcmp(rgb + 1, expected, sizeof(expected)) == 0);
+        assert(rgb[0] == 0xABAB && rgb[PIXELS + 1] == 0xABAB);
+    }
+
+    uint32_t argbPalette[4];
+    res = zelConvertPaletteToArgb8888(palette, 4, ZEL_COLOR_RGB565_LE, argbPalette);
+    assert(res == ZEL_OK);
+    assert(argbPalette[0] == 0xFF000000u);
+    assert(argbPalette[1] == 0xFFFF0000u);
+    assert(argbPalette[2] == 0xFF00FF00u);
+    assert(argbPalette[3] == 0xFF0000FFu);
+
+    const uint16_t bePalette[1] = {swap_u16(0xF800)};
+    uint32_t beArgb = 0;
+    res = zelConvertPaletteToArgb8888(bePalette, 1, ZEL_COLOR_RGB565_BE, &beArgb);
+    assert(res == ZEL_OK && beArgb == 0xFFFF0000u);
+
+    uint32_t argb[PIXELS];
+    res = zelRenderIndex8Argb8888(indices, W, W, H, argbPalette, 4, argb, W);
+    assert(res == ZEL_OK);
+    for (size_t i = 0; i < PIXELS; ++i)
+        assert(argb[i] == argbPalette[pixels[i]]);
+
+    uint16_t rgb[PIXELS];
+    res = zelRenderIndex8Rgb565(indices, W, W, H, palette, 3, rgb, W);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    res = zelRenderIndex8Rgb565(indices, W - 1, W, H, palette, 4, rgb, W);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_decode_oriented(void) {
+    enum { W = 8, H = 6, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0xFFFF};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 11, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 3, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    uint16_t upright[PIXELS];
+    res = zelDecodeFrameRgb565(ctx, 0, upright, W);
+    assert(res == ZEL_OK);
+
+    for (unsigned orientation = 0; orientation < 8; ++orientation) {
+        int transpose = (orientation & ZEL_ORIENTATION_TRANSPOSE) != 0;
+        size_t outW = transpose ? H : W;
+        size_t outH = transpose ? W : H;
+        size_t stride = outW + 3;
+
+        uint16_t out[(W + 3) * W];
+        memset(out, 0, sizeof(out));
+        res = zelDecodeFrameRgb565Oriented(ctx, 0, (ZELOrientation)orientation, out, stride);
+        assert(res == ZEL_OK);
+
+        for (size_t oy = 0; oy < outH; ++oy) {
+            for (size_t ox = 0; ox < outW; ++ox) {
+                size_t ux = (orientation & ZEL_ORIENTATION_FLIP_X) ? outW - 1 - ox : ox;
+                size_t uy = (orientation & ZEL_ORIENTATION_FLIP_Y) ? outH - 1 - oy : oy;
+                size_t sx = transpose ? uy : ux;
+                size_t sy = transpose ? ux : uy;
+                assert(out[oy * stride + ox] == upright[sy * W + sx]);
+            }
+        }
+    }
+
+    /* Clockwise quarter turn: the top-left source pixel lands in the top-right corner. */
+    uint16_t rotated[PIXELS];
+    res = zelDecodeFrameRgb565Oriented(ctx, 0, ZEL_ORIENTATION_ROTATE_90, rotated, H);
+    assert(res == ZEL_OK);
+    assert(rotated[H - 1] == upright[0]);
+
+    res = zelDecodeFrameRgb565Oriented(ctx, 0, ZEL_ORIENTATION_ROTATE_270, rotated, H - 1);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+    res = zelDecodeFrameRgb565Oriented(ctx, 0, (ZELOrientation)8, rotated, W);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(ctx);
+    free(data);
+}
+
+typedef struct {
+    uint16_t *frame;
+    size_t stride;
+    const uint16_t *previousPixels;
+    uint16_t previousCopy[12];
+    uint32_t calls;
+    uint32_t failAt;
+} TestZoneSink;
+
+static ZELResult test_zone_sink(void *userData,
+                                uint16_t x,
+                                uint16_t y,
+                                uint16_t width,
+                                uint16_t height,
+                                const uint16_t *pixels) {
+    TestZoneSink *sink = (TestZoneSink *)userData;
+    assert(width == 4 && height == 3);
+
+    /* The previous zone must still be intact while this one is handed over. */
+    if (sink->previousPixels) {
+        assert(pixels != sink->previousPixels);
+        assert(memcmp(sink->previousPixels, sink->previousCopy, sizeof(sink->previousCopy)) == 0);
+    }
+    sink->previousPixels = pixels;
+    memcpy(sink->previousCopy, pixels, sizeof(sink->previousCopy));
+
+    for (uint16_t row = 0; row < height; ++row)
+        memcpy(sink->frame + (size_t)(y + row) * sink->stride + x,
+               pixels + (size_t)row * width,
+               width * sizeof(uint16_t));
+
+    if (++sink->calls == sink->failAt)
+        return ZEL_ERR_IO;
+    return ZEL_OK;
+}
+
+static void test_decode_to_zones(void) {
+    enum { W = 8, H = 6, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0xFFFF};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 5, 5);
+
+    for (int compression = 0; compression < 2; ++compression) {
+        TestAnimationSpec spec = {W, H, 4, 3, 1, pixels, palette, 5,
+                                  compression ? ZEL_COMPRESSION_LZ4 : ZEL_COMPRESSION_NONE,
+                                  NULL};
+        size_t size = 0;
+        uint8_t *data = buildZelAnimation(&spec, &size);
+        ZELResult res;
+        ZELContext *ctx = zelOpenMemory(data, size, &res);
+        assert(ctx && res == ZEL_OK);
+
+        uint16_t expected[PIXELS];
+        expand_test_pixels(expected, pixels, PIXELS, palette);
+
+        uint16_t frame[PIXELS];
+        TestZoneSink sink;
+        memset(&sink, 0, sizeof(sink));
+        sink.frame = frame;
+        sink.stride = W;
+        res = zelDecodeFrameRgb565ToZones(ctx, 0, NULL, test_zone_sink, &sink);
+        assert(res == ZEL_OK);
+        assert(sink.calls == 4);
+        assert(memcmp(frame, expected, sizeof(expected)) == 0);
+
+        uint16_t buffers[2 * 12];
+        memset(&sink, 0, sizeof(sink));
+        memset(frame, 0, sizeof(frame));
+        sink.frame = frame;
+        sink.stride = W;
+        res = zelDecodeFrameRgb565ToZones(ctx, 0, buffers, test_zone_sink, &sink);
+        assert(res == ZEL_OK);
+        assert(memcmp(frame, expected, sizeof(expected)) == 0);
+        assert(sink.previousPixels == buffers + 12);
+
+        memset(&sink, 0, sizeof(sink));
+        sink.frame = frame;
+        sink.stride = W;
+        sink.failAt = 2;
+        res = zelDecodeFrameRgb565ToZones(ctx, 0, NULL, test_zone_sink, &sink);
+        assert(res == ZEL_ERR_IO);
+        assert(sink.calls == 2);
+
+        res = zelDecodeFrameRgb565ToZones(ctx, 0, NULL, NULL, NULL);
+        assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+        zelClose(ctx);
+        free(data);
+    }
+}
+
+static uint32_t test_fake_clock(void *userData) {
+    uint32_t *now = (uint32_t *)userData;
+    uint32_t value = *now;
+    *now += 10;
+    return value;
+}
+
+static void test_frame_decoder_steps(void) {
+    enum { W = 8, H = 6, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0xFFFF};
+    uint8_t pixels[2 * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 17, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 3, 2, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    ZELFrameDecoder *decoder = zelCreateFrameDecoder(ctx, &res);
+    assert(decoder && res == ZEL_OK);
+
+    uint16_t expected[PIXELS];
+    expand_test_pixels(expected, pixels, PIXELS, palette);
+
+    int done = 0;
+    res = zelFrameDecoderStep(decoder, 1, &done);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    /* One zone per step, with an unrelated decode on the same context between steps. */
+    uint16_t out[PIXELS];
+    uint16_t other[PIXELS];
+    memset(out, 0, sizeof(out));
+    res = zelFrameDecoderBegin(decoder, 0, out, W);
+    assert(res == ZEL_OK);
+    uint32_t steps = 0;
+    while (!done) {
+        res = zelFrameDecoderStep(decoder, 1, &done);
+        assert(res == ZEL_OK);
+        res = zelDecodeFrameRgb565(ctx, 1, other, W);
+        assert(res == ZEL_OK);
+        ++steps;
+    }
+    assert(steps == 4);
+    assert(memcmp(out, expected, sizeof(expected)) == 0);
+
+    res = zelFrameDecoderStep(decoder, 1, &done);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    /* The fake clock advances 10us per read, so a 15us budget covers two zones. */
+    uint32_t now = UINT32_MAX - 5;
+    memset(out, 0, sizeof(out));
+    res = zelFrameDecoderBegin(decoder, 0, out, W);
+    assert(res == ZEL_OK);
+    steps = 0;
+    done = 0;
+    while (!done) {
+        res = zelFrameDecoderStepTimed(decoder, 15, test_fake_clock, &now, &done);
+        assert(res == ZEL_OK);
+        ++steps;
+    }
+    assert(steps == 2);
+    assert(memcmp(out, expected, sizeof(expected)) == 0);
+
+    res = zelFrameDecoderBegin(decoder, 2, out, W);
+    assert(res != ZEL_OK);
+
+    zelDestroyFrameDecoder(decoder);
+    zelClose(ctx);
+    free(data);
+}
+
+typedef struct {
+    TestMemoryStream memory;
+    size_t largestRead;
+} TestCountingStream;
+
+static size_t test_counting_stream_read(void *userData, size_t offset, void *dst, size_t size) {
+    TestCountingStream *stream = (TestCountingStream *)userData;
+    if (size > stream->largestRead)
+        stream->largestRead = size;
+    return test_memory_stream_read(&stream->memory, offset, dst, size);
+}
+
+static void test_stream_zone_reads(void) {
+    enum { W = 32, H = 16, ZW = 16, ZH = 8, PIXELS = W * H, ZONE = ZW * ZH };
+    uint16_t palette[256];
+    for (uint32_t i = 0; i < 256; ++i)
+        palette[i] = (uint16_t)(i * 257u);
+
+    /* Noise makes LZ4 chunks larger than the zone they encode. */
+    uint8_t pixels[PIXELS];
+    uint32_t seed = 99;
+    for (size_t i = 0; i < PIXELS; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        pixels[i] = (uint8_t)(seed >> 16);
+    }
+    uint16_t expected[PIXELS];
+    expand_test_pixels(expected, pixels, PIXELS, palette);
+
+    for (int variant = 0; variant < 3; ++variant) {
+        uint8_t compressible[PIXELS];
+        fill_test_pixels(compressible, sizeof(compressible), 7, 256);
+        const uint8_t *source = variant == 2 ? compressible : pixels;
+        uint16_t reference[PIXELS];
+        expand_test_pixels(reference, source, PIXELS, palette);
+        if (variant != 2)
+            assert(memcmp(reference, expected, sizeof(reference)) == 0);
+
+        TestAnimationSpec spec = {W, H, ZW, ZH, 1, source, palette, 256,
+                                  variant == 0 ? ZEL_COMPRESSION_NONE : ZEL_COMPRESSION_LZ4,
+                                  NULL};
+        size_t size = 0;
+        uint8_t *data = buildZelAnimation(&spec, &size);
+        if (variant == 1) {
+            uint32_t chunkSize = 0;
+            locate_test_chunk(data, 256, 0, 0, &chunkSize);
+            assert(chunkSize > ZONE);
+        }
+
+        TestCountingStream counting = {{data, size}, 0};
+        ZELInputStream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.read = test_counting_stream_read;
+        stream.userData = &counting;
+        stream.size = size;
+
+        ZELResult res;
+        ZELContext *ctx = zelOpenStream(&stream, &res);
+        assert(ctx && res == ZEL_OK);
+        assert(zelSetStreamReadMode(ctx, (ZELStreamReadMode)2) == ZEL_ERR_INVALID_ARGUMENT);
+        assert(zelSetStreamReadMode(ctx, ZEL_STREAM_READ_ZONE) == ZEL_OK);
+
+        for (int trusted = 0; trusted < 2; ++trusted) {
+            if (trusted) {
+                assert(zelValidate(ctx, NULL, NULL) == ZEL_OK);
+                assert(zelSetTrustedMode(ctx, 1) == ZEL_OK);
+            }
+
+            counting.largestRead = 0;
+            uint16_t frame[PIXELS];
+            res = zelDecodeFrameRgb565(ctx, 0, frame, W);
+            assert(res == ZEL_OK);
+            assert(memcmp(frame, reference, sizeof(frame)) == 0);
+            /* No read covers more than one zone chunk. */
+            assert(counting.largestRead <= ZONE + ZONE / 255 + 16);
+
+            uint16_t zone[ZONE];
+            res = zelDecodeFrameRgb565Zone(ctx, 0, 3, zone);
+            assert(res == ZEL_OK);
+            for (uint32_t row = 0; row < ZH; ++row)
+                assert(memcmp(zone + row * ZW,
+                              reference + (size_t)(ZH + row) * W + ZW,
+                              ZW * sizeof(uint16_t))
+                       == 0);
+        }
+
+        zelClose(ctx);
+        free(data);
+    }
+}
+
+static void test_frame_copy_descriptors(void) {
+    enum { W = 8, H = 6, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0xFFFF};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 23, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 3, 1, pixels, palette, 5, ZEL_COMPRESSION_NONE, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    uint8_t expected[PIXELS];
+    res = zelDecodeFrameIndex8(ctx, 0, expected, W);
+    assert(res == ZEL_OK);
+
+    size_t count = 0;
+    res = zelBuildFrameIndex8Copies(ctx, 0, NULL, expected, W, NULL, 0, &count);
+    assert(res == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(count == 12);
+
+    ZELCopyDescriptor copies[12];
+    uint8_t frame[PIXELS];
+    memset(frame, 0xEE, sizeof(frame));
+    res = zelBuildFrameIndex8Copies(ctx, 0, NULL, frame, W, copies, 12, &count);
+    assert(res == ZEL_OK && count == 12);
+    assert(frame[0] == 0xEE);
+    zelExecuteCopies(copies, count);
+    assert(memcmp(frame, expected, sizeof(frame)) == 0);
+
+    /* The region straddles all four zones; everything outside it stays untouched. */
+    const ZELRect region = {3, 2, 4, 3};
+    memset(frame, 0xEE, sizeof(frame));
+    res = zelBuildFrameIndex8Copies(ctx, 0, &region, frame, W, copies, 12, &count);
+    assert(res == ZEL_OK && count == 6);
+    zelExecuteCopies(copies, count);
+    for (uint32_t y = 0; y < H; ++y) {
+        for (uint32_t x = 0; x < W; ++x) {
+            int inside = x >= 3 && x < 7 && y >= 2 && y < 5;
+            assert(frame[y * W + x] == (inside ? expected[y * W + x] : 0xEE));
+        }
+    }
+
+    const ZELRect outside = {6, 0, 4, 1};
+    res = zelBuildFrameIndex8Copies(ctx, 0, &outside, frame, W, copies, 12, &count);
+    assert(res == ZEL_ERR_OUT_OF_BOUNDS);
+    zelClose(ctx);
+    free(data);
+
+    /* Full-width zones written with a tight stride collapse into one copy per zone. */
+    TestAnimationSpec wide = {W, H, W, 3, 1, pixels, palette, 5, ZEL_COMPRESSION_NONE, NULL};
+    data = buildZelAnimation(&wide, &size);
+    ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+    res = zelBuildFrameIndex8Copies(ctx, 0, NULL, frame, W, copies, 12, &count);
+    assert(res == ZEL_OK && count == 2);
+    assert(copies[0].length == W * 3);
+    zelExecuteCopies(copies, count);
+    assert(memcmp(frame, pixels, sizeof(frame)) == 0);
+    zelClose(ctx);
+    free(data);
+
+    TestAnimationSpec packed = {W, H, 4, 3, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    data = buildZelAnimation(&packed, &size);
+    ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+    res = zelBuildFrameIndex8Copies(ctx, 0, NULL, frame, W, copies, 12, &count);
+    assert(res == ZEL_ERR_UNSUPPORTED_FORMAT);
+    zelClose(ctx);
+    free(data);
+}
+
+static uint16_t blend_reference(uint16_t under, uint16_t over, uint32_t alpha) {
+    static const uint32_t shifts[3] = {11, 5, 0};
+    static const uint32_t masks[3] = {0x1F, 0x3F, 0x1F};
+    uint16_t out = 0;
+    for (int c = 0; c < 3; ++c) {
+        int32_t b = (int32_t)((under >> shifts[c]) & masks[c]);
+        int32_t f = (int32_t)((over >> shifts[c]) & masks[c]);
+        int32_t diff = (f - b) * (int32_t)alpha;
+        int32_t step = diff >= 0 ? diff / 32 : -((-diff + 31) / 32);
+        out = (uint16_t)(out | (uint16_t)((uint32_t)(b + step) << shifts[c]));
+    }
+    return out;
+}
+
+static void test_alpha_palette_blend(void) {
+    enum { W = 8, H = 6, PIXELS = W * H };
+    /* transparent, opaque red, half green, opaque blue, faint white */
+    static const uint16_t palette[5] = {0x0F00, 0xFF00, 0x80F0, 0xF00F, 0x3FFF};
+    uint8_t pixels[PIXELS];
+    for (uint32_t y = 0; y < H; ++y) {
+        for (uint32_t x = 0; x < W; ++x) {
+            uint8_t value = (uint8_t)((x * 3 + y) % 5);
+            if (y < 3)
+                value = x < 4 ? 0 : 1; /* an all-transparent and an all-opaque zone */
+            pixels[y * W + x] = value;
+        }
+    }
+
+    for (int encoding = 0; encoding < 2; ++encoding) {
+        TestAnimationSpec spec = {W, H, 4, 3, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+        size_t size = 0;
+        uint8_t *data = buildZelAnimation(&spec, &size);
+        data[ZEL_FILE_HEADER_DISK_SIZE + 4] = ZEL_COLOR_ARGB4444_LE;
+
+        ZELResult res;
+        ZELContext *ctx = zelOpenMemory(data, size, &res);
+        assert(ctx && res == ZEL_OK);
+        assert(zelGetOutputColorEncoding(ctx) == ZEL_COLOR_RGB565_LE);
+        if (encoding)
+            zelSetOutputColorEncoding(ctx, ZEL_COLOR_RGB565_BE);
+        zelSetOutputColorEncoding(ctx, ZEL_COLOR_ARGB4444_LE);
+        assert(zelGetOutputColorEncoding(ctx)
+               == (encoding ? ZEL_COLOR_RGB565_BE : ZEL_COLOR_RGB565_LE));
+
+        const uint16_t *resolved = NULL;
+        uint16_t count = 0;
+        res = zelGetGlobalPalette(ctx, &resolved, &count);
+        assert(res == ZEL_OK && count == 5);
+        uint16_t rgb[5];
+        for (int i = 0; i < 5; ++i)
+            rgb[i] = encoding ? swap_u16(resolved[i]) : resolved[i];
+        assert(rgb[1] == 0xF800 && rgb[3] == 0x001F && rgb[4] == 0xFFFF);
+
+        uint16_t under[PIXELS];
+        uint16_t frame[PIXELS];
+        for (size_t i = 0; i < PIXELS; ++i)
+            under[i] = (uint16_t)(0x1234u + i * 0x0841u);
+        for (size_t i = 0; i < PIXELS; ++i)
+            frame[i] = encoding ? swap_u16(under[i]) : under[i];
+
+        res = zelDecodeFrameRgb565Blend(ctx, 0, frame, W);
+        assert(res == ZEL_OK);
+        for (size_t i = 0; i < PIXELS; ++i) {
+            uint32_t alpha = ((uint32_t)(palette[pixels[i]] >> 12) * 32u + 7u) / 15u;
+            uint16_t expected = blend_reference(under[i], rgb[pixels[i]], alpha);
+            assert((encoding ? swap_u16(frame[i]) : frame[i]) == expected);
+        }
+
+        uint32_t argb[5];
+        res = zelConvertPaletteToArgb8888(palette, 5, ZEL_COLOR_ARGB4444_LE, argb);
+        assert(res == ZEL_OK);
+        assert(argb[0] == 0x00FF0000u && argb[2] == 0x8800FF00u);
+
+        zelClose(ctx);
+        free(data);
+    }
+}
+
+static void test_decode_packed_formats(void) {
+    enum { W = 9, H = 4, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 31, 5);
+
+    /* 3-pixel zones put every other zone edge on an odd pixel. */
+    TestAnimationSpec spec = {W, H, 3, 2, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    for (int format = ZEL_PACKED_RGB444; format <= ZEL_PACKED_BGR888; ++format) {
+        int nibbles = format == ZEL_PACKED_RGB444 || format == ZEL_PACKED_BGR444;
+        int bgr = format & 1;
+        size_t rowBytes = nibbles ? (W * 3 + 1) / 2 : W * 3;
+        size_t stride = rowBytes + 2;
+
+        uint8_t out[(W * 3 + 2) * H];
+        memset(out, 0xA5, sizeof(out));
+        res = zelDecodeFramePacked(ctx, 0, (ZELPackedFormat)format, out, stride);
+        assert(res == ZEL_OK);
+
+        for (uint32_t y = 0; y < H; ++y) {
+            for (uint32_t x = 0; x < W; ++x) {
+                uint16_t value = palette[pixels[y * W + x]];
+                uint32_t r = (value >> 11) & 0x1Fu;
+                uint32_t g = (value >> 5) & 0x3Fu;
+                uint32_t b = value & 0x1Fu;
+                uint32_t c[3] = {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+                if (bgr) {
+                    uint32_t t = c[0];
+                    c[0] = c[2];
+                    c[2] = t;
+                }
+                const uint8_t *row = out + y * stride;
+                for (int k = 0; k < 3; ++k) {
+                    if (nibbles) {
+                        size_t n = (size_t)x * 3 + (size_t)k;
+                        uint8_t nib = (n & 1) ? (row[n / 2] & 0x0F) : (row[n / 2] >> 4);
+                        assert(nib == c[k] >> 4);
+                    } else if (format == ZEL_PACKED_RGB666 || format == ZEL_PACKED_BGR666) {
+                        assert(row[x * 3 + k] == (c[k] & 0xFCu));
+                    } else {
+                        assert(row[x * 3 + k] == c[k]);
+                    }
+                }
+            }
+            assert(out[y * stride + rowBytes] == 0xA5);
+        }
+    }
+
+    uint8_t small[W * 3 * H];
+    res = zelDecodeFramePacked(ctx, 0, ZEL_PACKED_RGB888, small, W * 3 - 1);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+    res = zelDecodeFramePacked(ctx, 0, (ZELPackedFormat)6, small, W * 3);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static uint32_t gray_reference(uint16_t rgb,
+                               uint32_t maxLevel,
+                               int dither,
+                               uint32_t x,
+                               uint32_t y) {
+    static const uint32_t bayer[16] = {0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5};
+    uint32_t r = (rgb >> 11) & 0x1Fu;
+    uint32_t g = (rgb >> 5) & 0x3Fu;
+    uint32_t b = rgb & 0x1Fu;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    uint32_t luma = (r * 77u + g * 150u + b * 29u + 128u) >> 8;
+    uint32_t level = luma * maxLevel / 255u;
+    uint32_t remainder = luma * maxLevel % 255u;
+    if (level >= maxLevel)
+        return maxLevel;
+    uint32_t threshold = bayer[((y & 3u) << 2) | (x & 3u)];
+    int up = dither ? remainder * 16u > threshold * 255u + 127u : remainder * 2u >= 255u;
+    return level + (up ? 1u : 0u);
+}
+
+static void test_decode_gray_formats(void) {
+    enum { W = 6, H = 10, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xFFFF, 0x8410, 0xF800, 0x4208};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 41, 5);
+
+    /* 3x5 zones split destination bytes both across rows and across pages. */
+    TestAnimationSpec spec = {W, H, 3, 5, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    for (int format = ZEL_GRAY_MONO1_ROWS; format <= ZEL_GRAY_GRAY4_ROWS; ++format) {
+        for (int dither = 0; dither < 2; ++dither) {
+            uint8_t out[4 * H];
+            size_t stride = format == ZEL_GRAY_MONO1_PAGES ? W + 1 : 4;
+            memset(out, 0x5A, sizeof(out));
+            res = zelDecodeFrameGray(ctx, 0, (ZELGrayFormat)format, dither, out, stride);
+            assert(res == ZEL_OK);
+
+            uint32_t maxLevel = format == ZEL_GRAY_GRAY4_ROWS ? 15u : 1u;
+            for (uint32_t y = 0; y < H; ++y) {
+                for (uint32_t x = 0; x < W; ++x) {
+                    uint32_t value = 0;
+                    if (format == ZEL_GRAY_MONO1_ROWS)
+                        value = (out[y * stride + x / 8] >> (7 - x % 8)) & 1u;
+                    else if (format == ZEL_GRAY_MONO1_PAGES)
+                        value = (out[(y / 8) * stride + x] >> (y % 8)) & 1u;
+                    else
+                        value = (out[y * stride + x / 2] >> ((x & 1) ? 0 : 4)) & 0xFu;
+                    uint16_t rgb = palette[pixels[y * W + x]];
+                    assert(value == gray_reference(rgb, maxLevel, dither, x, y));
+                }
+            }
+            /* Bits outside the frame are left alone. */
+            if (format == ZEL_GRAY_MONO1_ROWS)
+                assert((out[0 * stride] & 0x03u) == (0x5Au & 0x03u));
+            if (format == ZEL_GRAY_MONO1_PAGES)
+                assert((out[stride + 2] & 0xFCu) == (0x5Au & 0xFCu));
+        }
+    }
+
+    assert(gray_reference(0xFFFF, 1, 1, 0, 0) == 1 && gray_reference(0x0000, 15, 1, 0, 0) == 0);
+    uint32_t lit = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+        lit += gray_reference(0x8410, 1, 1, i & 3u, i >> 2);
+    assert(lit == 8);
+
+    uint8_t small[W];
+    res = zelDecodeFrameGray(ctx, 0, ZEL_GRAY_MONO1_PAGES, 0, small, W - 1);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+    res = zelDecodeFrameGray(ctx, 0, (ZELGrayFormat)3, 0, small, W);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_decode_lut_formats(void) {
+    enum { W = 9, H = 4, PIXELS = W * H };
+    static const uint16_t palette[6] = {0x0000, 0xF800, 0x07E0, 0x001F, 0xFFFF, 0x8C51};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 3, 6);
+
+    TestAnimationSpec spec = {W, H, 3, 2, 1, pixels, palette, 6, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    uint8_t lut[6 * 4];
+    for (size_t i = 0; i < sizeof(lut); ++i)
+        lut[i] = (uint8_t)(i * 37 + 11);
+
+    for (uint32_t element = 1; element <= 4; ++element) {
+        size_t pitch = W * element + 3;
+        uint8_t out[(W * 4 + 3) * H];
+        memset(out, 0xA5, sizeof(out));
+        res = zelDecodeFrameLut(ctx, 0, lut, 6, element, out, pitch);
+        assert(res == ZEL_OK);
+
+        for (uint32_t y = 0; y < H; ++y) {
+            const uint8_t *row = out + y * pitch;
+            for (uint32_t x = 0; x < W; ++x)
+                assert(memcmp(row + x * element, lut + pixels[y * W + x] * element, element) == 0);
+            assert(row[W * element] == 0xA5);
+        }
+    }
+
+    /* Indices past the end of the caller's table are rejected like palette overruns. */
+    uint8_t small[W * 2 * H];
+    res = zelDecodeFrameLut(ctx, 0, lut, 4, 2, small, W * 2);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    res = zelDecodeFrameLut(ctx, 0, lut, 6, 2, small, W * 2 - 1);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+    res = zelDecodeFrameLut(ctx, 0, lut, 6, 5, small, W * 2);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+
+    /* Validation only covers the frame palette, so trusted mode still bounds a shorter table. */
+    uint8_t *shortLut = (uint8_t *)malloc(4);
+    assert(shortLut);
+    memcpy(shortLut, lut, 4);
+    assert(zelValidate(ctx, NULL, NULL) == ZEL_OK);
+    assert(zelSetTrustedMode(ctx, 1) == ZEL_OK);
+    uint8_t wide[W * 4 * H];
+    res = zelDecodeFrameLut(ctx, 0, shortLut, 1, 4, wide, W * 4);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+    res = zelDecodeFrameLut(ctx, 0, lut, 6, 4, wide, W * 4);
+    assert(res == ZEL_OK);
+    free(shortLut);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_decode_positioned_clipped(void) {
+    enum { W = 12, H = 8, PIXELS = W * H, CW = 16, CH = 10 };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 7, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, 1, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    uint16_t canvas[CW * CH];
+    memset(canvas, 0xA5, sizeof(canvas));
+    const ZELRect clip = {1, 1, 10, 6};
+    res = zelDecodeFrameRgb565At(ctx, 0, -3, 2, &clip, canvas, CW);
+    assert(res == ZEL_OK);
+
+    for (int y = 0; y < CH; ++y) {
+        for (int x = 0; x < CW; ++x) {
+            int fx = x + 3;
+            int fy = y - 2;
+            int inClip = x >= 1 && x < 11 && y >= 1 && y < 7;
+            int inFrame = fx >= 0 && fx < W && fy >= 0 && fy < H;
+            uint16_t expected = inClip && inFrame ? palette[pixels[fy * W + fx]] : 0xA5A5;
+            assert(canvas[y * CW + x] == expected);
+        }
+    }
+
+    /* Zone 0 lies left of the clip, so damaging it must not affect a clipped decode. */
+    uint32_t chunkSize = 0;
+    size_t payload = locate_test_chunk(data, 5, 0, 0, &chunkSize);
+    memset(data + payload, 0xFF, chunkSize);
+    res = zelDecodeFrameRgb565At(ctx, 0, -3, 2, &clip, canvas, CW);
+    assert(res == ZEL_OK);
+    uint16_t full[PIXELS];
+    res = zelDecodeFrameRgb565(ctx, 0, full, W);
+    assert(res == ZEL_ERR_CORRUPT_DATA);
+
+    /* A frame placed entirely outside the clip writes nothing. */
+    memset(canvas, 0xA5, sizeof(canvas));
+    res = zelDecodeFrameRgb565At(ctx, 0, 11, 0, &clip, canvas, CW);
+    assert(res == ZEL_OK);
+    for (int i = 0; i < CW * CH; ++i)
+        assert(canvas[i] == 0xA5A5);
+
+    res = zelDecodeFrameRgb565At(ctx, 0, 0, 0, &clip, canvas, 10);
+    assert(res == ZEL_ERR_INVALID_ARGUMENT);
+    res = zelDecodeFrameRgb565At(ctx, 1, 0, 0, &clip, canvas, CW);
+    assert(res == ZEL_ERR_OUT_OF_BOUNDS);
+
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_player_pacing(void) {
+    size_t size = 0;
+    uint8_t *data = buildSimpleZelThreeFrames(&size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    /* Frames last 10, 20 and 30 ms; start close to the clock wrap to cover it. */
+    uint32_t start = UINT32_MAX - 25;
+    ZELPlayer *player = zelCreatePlayer(ctx, start, &res);
+    assert(player && res == ZEL_OK);
+
+    ZELPlayerTick tick;
+    res = zelPlayerUpdate(player, start, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 0 && tick.frameChanged && tick.framesDropped == 0);
+    assert(tick.nextDeadlineMs == start + 10);
+
+    res = zelPlayerUpdate(player, start + 5, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 0 && !tick.frameChanged);
+    assert(tick.nextDeadlineMs == start + 10);
+
+    res = zelPlayerUpdate(player, start + 12, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 1 && tick.frameChanged && tick.framesDropped == 0);
+    assert(tick.nextDeadlineMs == start + 30);
+
+    /* An overloaded caller returns at 65 ms: frame 2 is skipped for the next loop's frame 0. */
+    res = zelPlayerUpdate(player, start + 65, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 0 && tick.frameChanged && tick.framesDropped == 1);
+    assert(tick.nextDeadlineMs == start + 70);
+    assert(zelPlayerGetDroppedFrames(player) == 1);
+
+    /* A clock that steps backwards holds the frame and counts on from the new reading. */
+    res = zelPlayerUpdate(player, start + 61, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 0 && !tick.frameChanged && tick.framesDropped == 0);
+
+    /* Returning a whole loop later lands on the frame already shown: nothing to decode. */
+    res = zelPlayerUpdate(player, start + 121, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 0 && !tick.frameChanged && tick.framesDropped == 2);
+
+    zelPlayerReset(player, 1000);
+    res = zelPlayerUpdate(player, 1031, &tick);
+    assert(res == ZEL_OK);
+    assert(tick.frameIndex == 2 && tick.frameChanged && tick.framesDropped == 2);
+    assert(tick.nextDeadlineMs == 1060);
+    assert(zelPlayerGetDroppedFrames(player) == 2);
+
+    zelDestroyPlayer(player);
+    assert(zelCreatePlayer(NULL, 0, &res) == NULL && res == ZEL_ERR_INVALID_ARGUMENT);
+    zelClose(ctx);
+    free(data);
+}
+
+typedef struct {
+    const uint8_t *pixels;
+    const uint16_t *palette;
+    int32_t width;
+    int32_t height;
+} TestLayerImage;
+
+/* Layers must be passed bottom to top. */
+static void composite_reference(const ZELLayer *layers,
+                                const TestLayerImage *images,
+                                uint32_t count,
+                                uint16_t background,
+                                uint16_t *out,
+                                int32_t width,
+                                int32_t height) {
+    for (int32_t i = 0; i < width * height; ++i)
+        out[i] = background;
+    for (uint32_t l = 0; l < count; ++l) {
+        for (int32_t y = 0; y < images[l].height; ++y) {
+            for (int32_t x = 0; x < images[l].width; ++x) {
+                int32_t sx = layers[l].x + x;
+                int32_t sy = layers[l].y + y;
+                uint8_t idx = images[l].pixels[y * images[l].width + x];
+                if (sx < 0 || sy < 0 || sx >= width || sy >= height ||
+                    idx == layers[l].transparentIndex)
+                    continue;
+                out[sy * width + sx] = images[l].palette[idx];
+            }
+        }
+    }
+}
+
+static void test_compositor_layers(void) {
+    enum { SW = 24, SH = 16 };
+    static const uint16_t paletteA[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    static const uint16_t paletteB[4] = {0x0000, 0xFFE0, 0x07FF, 0xF81F};
+    static const uint16_t paletteC[3] = {0x1234, 0x4321, 0xABCD};
+    uint8_t pixelsA[16 * 8];
+    uint8_t pixelsB[8 * 8];
+    uint8_t pixelsC[SW * SH];
+    fill_test_pixels(pixelsA, sizeof(pixelsA), 1, 5);
+    fill_test_pixels(pixelsB, sizeof(pixelsB), 2, 4);
+    fill_test_pixels(pixelsC, sizeof(pixelsC), 3, 3);
+
+    TestAnimationSpec specA = {16, 8, 4, 4, 1, pixelsA, paletteA, 5, ZEL_COMPRESSION_LZ4, NULL};
+    TestAnimationSpec specB = {8, 8, 4, 4, 1, pixelsB, paletteB, 4, ZEL_COMPRESSION_LZ4, NULL};
+    TestAnimationSpec specC = {SW, SH, 8, 8, 1, pixelsC, paletteC, 3, ZEL_COMPRESSION_LZ4, NULL};
+    size_t sizeA = 0, sizeB = 0, sizeC = 0;
+    uint8_t *dataA = buildZelAnimation(&specA, &sizeA);
+    uint8_t *dataB = buildZelAnimation(&specB, &sizeB);
+    uint8_t *dataC = buildZelAnimation(&specC, &sizeC);
+    ZELResult res;
+    ZELContext *ctxA = zelOpenMemory(dataA, sizeA, &res);
+    assert(ctxA && res == ZEL_OK);
+    ZELContext *ctxB = zelOpenMemory(dataB, sizeB, &res);
+    assert(ctxB && res == ZEL_OK);
+    ZELContext *ctxC = zelOpenMemory(dataC, sizeC, &res);
+    assert(ctxC && res == ZEL_OK);
+
+    ZELCompositor *compositor = zelCreateCompositor(SW, SH, 8, &res);
+    assert(compositor && res == ZEL_OK);
+
+    const TestLayerImage images[3] = {
+            {pixelsA, paletteA, 16, 8}, {pixelsB, paletteB, 8, 8}, {pixelsC, paletteC, SW, SH}};
+    ZELLayer a = {ctxA, 0, -4, 2, 0, -1};
+    ZELLayer b = {ctxB, 0, 10, 5, 1, 0};
+    ZELLayer c = {ctxC, 0, 0, 0, 5, -1};
+
+    /* Passed top first: the compositor orders by z. */
+    ZELLayer layers[3] = {b, a, c};
+    ZELLayer ordered[3] = {a, b, c};
+    uint16_t screen[SW * SH];
+    uint16_t expected[SW * SH];
+    uint32_t tiles = 0;
+    res = zelComposite(compositor, layers, 2, 0x1111, screen, SW, &tiles);
+    assert(res == ZEL_OK && tiles == 6);
+    composite_reference(ordered, images, 2, 0x1111, expected, SW, SH);
+    assert(memcmp(screen, expected, sizeof(screen)) == 0);
+
+    res = zelComposite(compositor, layers, 2, 0x1111, screen, SW, &tiles);
+    assert(res == ZEL_OK && tiles == 0);
+    assert(memcmp(screen, expected, sizeof(screen)) == 0);
+
+    /* Moving b redraws only the tiles under its old and new positions. */
+    layers[0].x = 13;
+    layers[0].y = 7;
+    ordered[1] = layers[0];
+    res = zelComposite(compositor, layers, 2, 0x1111, screen, SW, &tiles);
+    assert(res == ZEL_OK && tiles == 4);
+    composite_reference(ordered, images, 2, 0x1111, expected, SW, SH);
+    assert(memcmp(screen, expected, sizeof(screen)) == 0);
+
+    /* With an opaque full-screen layer on top, a's zones are never decoded. */
+    uint32_t chunkSize = 0;
+    size_t payload = locate_test_chunk(dataA, 5, 0, 1, &chunkSize);
+    memset(dataA + payload, 0xFF, chunkSize);
+    uint16_t full[16 * 8];
+    assert(zelDecodeFrameRgb565(ctxA, 0, full, 16) == ZEL_ERR_CORRUPT_DATA);
+    res = zelComposite(compositor, layers, 3, 0x1111, screen, SW, &tiles);
+    assert(res == ZEL_OK && tiles == 6);
+    composite_reference(ordered, images, 3, 0x1111, expected, SW, SH);
+    assert(memcmp(screen, expected, sizeof(screen)) == 0);
+
+    ZELLayer bad = {ctxA, 1, 0, 0, 0, -1};
+    assert(zelComposite(compositor, &bad, 1, 0, screen, SW, NULL) == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(zelComposite(compositor, layers, 2, 0, screen, SW - 1, NULL) ==
+           ZEL_ERR_INVALID_ARGUMENT);
+
+    zelDestroyCompositor(compositor);
+    zelClose(ctxA);
+    zelClose(ctxB);
+    zelClose(ctxC);
+    free(dataA);
+    free(dataB);
+    free(dataC);
+}
+
+typedef struct {
+    uint32_t taskCount;
+} TestOrderedPool;
+
+/* Runs tasks in index order, as a pool handing out indices from a shared counter would. */
+static void test_ordered_pool_run(void *userData,
+                                  ZELTaskFunc task,
+                                  void *taskData,
+                                  uint32_t count) {
+    TestOrderedPool *pool = (TestOrderedPool *)userData;
+    for (uint32_t i = 0; i < count; ++i)
+        task(taskData, i, i % 3);
+    pool->taskCount = count;
+}
+
+static void test_scheduler_deadlines(void) {
+    enum { W = 16, H = 8, FRAMES = 3, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 21, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    ZELResult res;
+    ZELContext *ctx = zelOpenMemory(data, size, &res);
+    assert(ctx && res == ZEL_OK);
+
+    TestMemoryStream memStream = {data, size};
+    ZELInputStream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.read = test_memory_stream_read;
+    stream.userData = &memStream;
+    stream.size = size;
+    ZELContext *streamCtx = zelOpenStream(&stream, &res);
+    assert(streamCtx && res == ZEL_OK);
+
+    TestOrderedPool poolState;
+    memset(&poolState, 0, sizeof(poolState));
+    ZELWorkerPool pool = {test_ordered_pool_run, &poolState, 3};
+    ZELScheduler *scheduler = zelCreateScheduler(&pool, &res);
+    assert(scheduler && res == ZEL_OK);
+
+    static uint16_t out[4][PIXELS];
+    memset(out, 0, sizeof(out));
+    ZELScheduledJob jobs[4] = {
+            {ctx, 0, out[0], W, 200, 0, 0, ZEL_OK},
+            {ctx, 1, out[1], W, 20, 0, 0, ZEL_OK},
+            {ctx, 2, out[2], W, 120, 0, 0, ZEL_OK},
+            {streamCtx, 1, out[3], W, 300, 0, 0, ZEL_OK},
+    };
+
+    /* The fake clock advances 10us per reading: one at the start and one per finished task. */
+    uint32_t now = 0;
+    ZELScheduleReport report;
+    res = zelSchedulerRun(scheduler, jobs, 4, test_fake_clock, &now, &report);
+    assert(res == ZEL_OK);
+    assert(report.jobCount == 4 && report.taskCount == 10 && poolState.taskCount == 10);
+
+    /* Memory frames split into three bands each, run in deadline order 1, 2, 0, then the
+       streamed frame as a single task. */
+    assert(jobs[1].finishUs == 30 && jobs[2].finishUs == 60 && jobs[0].finishUs == 90);
+    assert(jobs[3].finishUs == 100);
+    assert(jobs[1].missedDeadline && !jobs[0].missedDeadline && !jobs[2].missedDeadline);
+    assert(report.missedDeadlines == 1 && report.worstLatenessUs == 10);
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        uint16_t expected[PIXELS];
+        assert(zelDecodeFrameRgb565(ctx, jobs[i].frameIndex, expected, W) == ZEL_OK);
+        assert(memcmp(out[i], expected, sizeof(expected)) == 0);
+    }
+
+    /* Scratch and task storage are reused; a bad job is reported without stopping the rest. */
+    memset(out, 0, sizeof(out));
+    jobs[2].frameIndex = FRAMES;
+    res = zelSchedulerRun(scheduler, jobs, 4, test_fake_clock, &now, &report);
+    assert(res == ZEL_ERR_OUT_OF_BOUNDS);
+    assert(jobs[2].result == ZEL_ERR_OUT_OF_BOUNDS && jobs[0].result == ZEL_OK);
+    assert(report.taskCount == 7);
+    uint16_t expected[PIXELS];
+    assert(zelDecodeFrameRgb565(ctx, 0, expected, W) == ZEL_OK);
+    assert(memcmp(out[0], expected, sizeof(expected)) == 0);
+
+    assert(zelSchedulerRun(scheduler, jobs, 4, NULL, NULL, NULL) == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelDestroyScheduler(scheduler);
+    zelClose(streamCtx);
+    zelClose(ctx);
+    free(data);
+}
+
+static void check_file_context(ZELContext *ctx, const uint8_t *pixels, const uint16_t *palette) {
+    enum { W = 16, H = 8, PIXELS = W * H };
+    for (uint32_t frame = 0; frame < 2; ++frame) {
+        uint16_t out[PIXELS];
+        assert(zelDecodeFrameRgb565(ctx, frame, out, W) == ZEL_OK);
+        for (uint32_t i = 0; i < PIXELS; ++i)
+            assert(out[i] == palette[pixels[frame * PIXELS + i]]);
+    }
+}
+
+static void test_file_stream_adapters(void) {
+    enum { W = 16, H = 8, FRAMES = 2, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    static const char *path = "zel_test_stream.tmp";
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 41, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    FILE *file = fopen(path, "w+b");
+    assert(file);
+    assert(fwrite(data, 1, size, file) == size);
+    assert(fflush(file) == 0);
+
+    ZELInputStream stream;
+    ZELResult res = zelInitStdioStream(file, &stream);
+    if (res == ZEL_ERR_UNSUPPORTED_FORMAT) {
+        printf("POSIX file streams unavailable; skipping adapter checks.\n");
+    } else {
+        assert(res == ZEL_OK && stream.size == size && stream.close == NULL);
+        ZELContext *ctx = zelOpenStream(&stream, &res);
+        assert(ctx && res == ZEL_OK);
+        check_file_context(ctx, pixels, palette);
+        zelClose(ctx);
+
+        ctx = zelOpenFile(path, 0, &res);
+        assert(ctx && res == ZEL_OK);
+        check_file_context(ctx, pixels, palette);
+        zelClose(ctx);
+
+        /* Some filesystems (tmpfs, overlays) refuse O_DIRECT at open time. */
+        ctx = zelOpenFile(path, ZEL_FILE_DIRECT, &res);
+        if (ctx) {
+            check_file_context(ctx, pixels, palette);
+            zelClose(ctx);
+        } else {
+            assert(res == ZEL_ERR_IO);
+        }
+
+        assert(zelOpenFile("zel_test_missing.tmp", 0, &res) == NULL && res == ZEL_ERR_IO);
+        assert(zelOpenFile(path, 0x80u, &res) == NULL && res == ZEL_ERR_INVALID_ARGUMENT);
+    }
+
+    fclose(file);
+    remove(path);
+    free(data);
+}
+
+static void check_prefetch_order(ZELContext *ctx, ZELContext *reference) {
+    enum { W = 16, H = 8, PIXELS = W * H };
+    /* In order, across the loop point, a seek, a repeat and a step backwards. */
+    static const uint32_t order[] = {0, 1, 2, 3, 4, 5, 0, 1, 4, 4, 2};
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); ++i) {
+        uint16_t out[PIXELS];
+        uint16_t expected[PIXELS];
+        assert(zelDecodeFrameRgb565(ctx, order[i], out, W) == ZEL_OK);
+        assert(zelDecodeFrameRgb565(reference, order[i], expected, W) == ZEL_OK);
+        assert(memcmp(out, expected, sizeof(out)) == 0);
+    }
+}
+
+static void test_uring_prefetch(void) {
+    enum { W = 16, H = 8, FRAMES = 6, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    static const char *path = "zel_test_prefetch.tmp";
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 43, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+    FILE *file = fopen(path, "wb");
+    assert(file);
+    assert(fwrite(data, 1, size, file) == size);
+    assert(fclose(file) == 0);
+
+    ZELResult res;
+    ZELContext *reference = zelOpenMemory(data, size, &res);
+    assert(reference && res == ZEL_OK);
+    assert(zelEnableUringPrefetch(reference, -1, 2) != ZEL_OK);
+
+    ZELContext *ctx = zelOpenFile(path, 0, &res);
+    if (!ctx) {
+        assert(res == ZEL_ERR_UNSUPPORTED_FORMAT);
+        printf("POSIX file streams unavailable; skipping prefetch checks.\n");
+    } else if ((res = zelEnableUringPrefetch(ctx, -1, 2)) == ZEL_ERR_UNSUPPORTED_FORMAT) {
+        printf("io_uring prefetch unavailable; skipping prefetch checks.\n");
+        zelClose(ctx);
+    } else {
+        assert(res == ZEL_OK);
+        check_prefetch_order(ctx, reference);
+        assert(zelEnableUringPrefetch(ctx, -1, 65) == ZEL_ERR_INVALID_ARGUMENT);
+
+        /* A deeper queue than the animation still loops correctly, and 0 turns it off. */
+        assert(zelEnableUringPrefetch(ctx, -1, 8) == ZEL_OK);
+        check_prefetch_order(ctx, reference);
+        assert(zelEnableUringPrefetch(ctx, -1, 0) == ZEL_OK);
+        check_prefetch_order(ctx, reference);
+        zelClose(ctx);
+
+        ctx = zelOpenFile(path, ZEL_FILE_DIRECT, &res);
+        if (ctx) {
+            assert(zelEnableUringPrefetch(ctx, -1, 3) == ZEL_OK);
+            check_prefetch_order(ctx, reference);
+            zelClose(ctx);
+        }
+    }
+
+    zelClose(reference);
+    remove(path);
+    free(data);
+}
+
+typedef struct {
+    TestMemoryStream memory;
+    size_t hintOffset[8];
+    size_t hintSize[8];
+    uint32_t hintCount;
+    size_t lastReadOffset;
+    size_t lastReadSize;
+    size_t bytesRead;
+    uint32_t hintedReads;
+    uint32_t readvCalls;
+    size_t readvRanges;
+    int failReadv;
+} TestHintStream;
+
+static size_t test_hint_stream_read(void *userData, size_t offset, void *dst, size_t size) {
+    TestHintStream *stream = (TestHintStream *)userData;
+    stream->lastReadOffset = offset;
+    stream->lastReadSize = size;
+    stream->bytesRead += size;
+    for (uint32_t i = 0; i < stream->hintCount; ++i) {
+        if (offset >= stream->hintOffset[i]
+            && offset + size <= stream->hintOffset[i] + stream->hintSize[i]) {
+            stream->hintedReads++;
+            break;
+        }
+    }
+    return test_memory_stream_read(&stream->memory, offset, dst, size);
+}
+
+static void test_hint_stream_hint(void *userData, size_t offset, size_t size) {
+    TestHintStream *stream = (TestHintStream *)userData;
+    assert(stream->hintCount < 8);
+    stream->hintOffset[stream->hintCount] = offset;
+    stream->hintSize[stream->hintCount] = size;
+    stream->hintCount++;
+}
+
+/* Serves ranges back to front, since the callback may fill them in any order. */
+static size_t test_hint_stream_readv(void *userData, const ZELStreamRange *ranges, size_t count) {
+    TestHintStream *stream = (TestHintStream *)userData;
+    stream->readvCalls++;
+    stream->readvRanges += count;
+    if (stream->failReadv)
+        return count - 1;
+    for (size_t i = count; i > 0; --i) {
+        const ZELStreamRange *range = &ranges[i - 1];
+        if (test_memory_stream_read(&stream->memory, range->offset, range->dst, range->size)
+            != range->size) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+static void test_stream_read_hints(void) {
+    enum { W = 16, H = 8, FRAMES = 4, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 47, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+
+    TestHintStream hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.memory.data = data;
+    hints.memory.size = size;
+    ZELInputStream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.read = test_hint_stream_read;
+    stream.userData = &hints;
+    stream.size = size;
+
+    ZELResult res;
+    ZELContext *ctx = zelOpenStream(&stream, &res);
+    assert(ctx && res == ZEL_OK);
+    assert(zelSetStreamHint(ctx, test_hint_stream_hint) == ZEL_OK);
+    ZELContext *reference = zelOpenMemory(data, size, &res);
+    assert(reference && res == ZEL_OK);
+
+    /* The first decode gives no direction; from the second on, the next block is hinted and is
+       exactly what the following decode reads. */
+    uint16_t out[PIXELS];
+    assert(zelDecodeFrameRgb565(ctx, 0, out, W) == ZEL_OK);
+    assert(hints.hintCount == 0);
+    assert(zelDecodeFrameRgb565(ctx, 1, out, W) == ZEL_OK);
+    assert(hints.hintCount == 1);
+    assert(zelDecodeFrameRgb565(ctx, 2, out, W) == ZEL_OK);
+    assert(hints.lastReadOffset == hints.hintOffset[0] && hints.lastReadSize == hints.hintSize[0]);
+    assert(zelDecodeFrameRgb565(ctx, 3, out, W) == ZEL_OK);
+    assert(hints.hintCount == 3);
+
+    /* Looping back to frame 0 was hinted after frame 3; repeats and jumps hint nothing. */
+    assert(zelDecodeFrameRgb565(ctx, 0, out, W) == ZEL_OK);
+    assert(hints.lastReadOffset == hints.hintOffset[2] && hints.lastReadSize == hints.hintSize[2]);
+    assert(hints.hintCount == 4);
+    assert(zelDecodeFrameRgb565(ctx, 0, out, W) == ZEL_OK);
+    assert(zelDecodeFrameRgb565(ctx, 2, out, W) == ZEL_OK);
+    assert(hints.hintCount == 4);
+
+    /* A clipped decode in zone-read mode hints zones 1-2 and 5-6 as two runs, and those four
+       chunks are the only reads inside hinted ranges. */
+    assert(zelSetStreamReadMode(ctx, ZEL_STREAM_READ_ZONE) == ZEL_OK);
+    hints.hintCount = 0;
+    hints.hintedReads = 0;
+    ZELRect clip = {4, 0, 8, 8};
+    uint16_t canvas[PIXELS];
+    uint16_t expected[PIXELS];
+    memset(canvas, 0, sizeof(canvas));
+    memset(expected, 0, sizeof(expected));
+    assert(zelDecodeFrameRgb565At(ctx, 1, 0, 0, &clip, canvas, W) == ZEL_OK);
+    assert(zelDecodeFrameRgb565At(reference, 1, 0, 0, &clip, expected, W) == ZEL_OK);
+    assert(memcmp(canvas, expected, sizeof(canvas)) == 0);
+    assert(hints.hintCount == 2 && hints.hintedReads == 4);
+    assert(hints.hintOffset[0] < hints.hintOffset[1]);
+
+    /* Without a hint callback the filtered zones are still skipped unread. */
+    ZELContext *plain = zelOpenStream(&stream, &res);
+    assert(plain && res == ZEL_OK);
+    assert(zelSetStreamReadMode(plain, ZEL_STREAM_READ_ZONE) == ZEL_OK);
+    ZELRect full = {0, 0, W, H};
+    hints.bytesRead = 0;
+    assert(zelDecodeFrameRgb565At(plain, 1, 0, 0, &full, canvas, W) == ZEL_OK);
+    size_t fullBytes = hints.bytesRead;
+    hints.bytesRead = 0;
+    memset(canvas, 0, sizeof(canvas));
+    assert(zelDecodeFrameRgb565At(plain, 1, 0, 0, &clip, canvas, W) == ZEL_OK);
+    assert(memcmp(canvas, expected, sizeof(canvas)) == 0);
+    assert(hints.bytesRead < fullBytes);
+
+    zelClose(plain);
+    zelClose(reference);
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_stream_vectored_reads(void) {
+    enum { W = 16, H = 8, FRAMES = 2, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 53, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+
+    TestHintStream hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.memory.data = data;
+    hints.memory.size = size;
+    ZELInputStream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.read = test_hint_stream_read;
+    stream.userData = &hints;
+    stream.size = size;
+
+    ZELResult res;
+    ZELContext *ctx = zelOpenStream(&stream, &res);
+    assert(ctx && res == ZEL_OK);
+    assert(zelSetStreamHint(ctx, test_hint_stream_hint) == ZEL_OK);
+    assert(zelSetStreamReadv(ctx, test_hint_stream_readv) == ZEL_OK);
+    assert(zelSetStreamReadMode(ctx, ZEL_STREAM_READ_ZONE) == ZEL_OK);
+    ZELContext *reference = zelOpenMemory(data, size, &res);
+    assert(reference && res == ZEL_OK);
+
+    /* Zones 1-2 and 5-6 arrive as the two hinted runs in a single call; no chunk goes through
+       read. */
+    ZELRect clip = {4, 0, 8, 8};
+    uint16_t canvas[PIXELS];
+    uint16_t expected[PIXELS];
+    memset(canvas, 0, sizeof(canvas));
+    memset(expected, 0, sizeof(expected));
+    assert(zelDecodeFrameRgb565At(ctx, 0, 0, 0, &clip, canvas, W) == ZEL_OK);
+    assert(zelDecodeFrameRgb565At(reference, 0, 0, 0, &clip, expected, W) == ZEL_OK);
+    assert(memcmp(canvas, expected, sizeof(canvas)) == 0);
+    assert(hints.readvCalls == 1 && hints.readvRanges == 2);
+    assert(hints.hintCount == 2 && hints.hintedReads == 0);
+
+    /* Whole-frame decodes keep using read. */
+    uint16_t out[PIXELS];
+    assert(zelDecodeFrameRgb565(ctx, 1, out, W) == ZEL_OK);
+    assert(zelDecodeFrameRgb565(reference, 1, expected, W) == ZEL_OK);
+    assert(memcmp(out, expected, sizeof(out)) == 0);
+    assert(hints.readvCalls == 1);
+
+    hints.failReadv = 1;
+    assert(zelDecodeFrameRgb565At(ctx, 0, 0, 0, &clip, canvas, W) == ZEL_ERR_IO);
+
+    zelClose(reference);
+    zelClose(ctx);
+    free(data);
+}
+
+static void test_stream_preload(void) {
+    enum { W = 16, H = 8, FRAMES = 3, PIXELS = W * H };
+    static const uint16_t palette[5] = {0x0000, 0xF800, 0x07E0, 0x001F, 0x8C51};
+    uint8_t pixels[FRAMES * PIXELS];
+    fill_test_pixels(pixels, sizeof(pixels), 59, 5);
+
+    TestAnimationSpec spec = {W, H, 4, 4, FRAMES, pixels, palette, 5, ZEL_COMPRESSION_LZ4, NULL};
+    size_t size = 0;
+    uint8_t *data = buildZelAnimation(&spec, &size);
+
+    TestHintStream counting;
+    memset(&counting, 0, sizeof(counting));
+    counting.memory.data = data;
+    counting.memory.size = size;
+    ZELInputStream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.read = test_hint_stream_read;
+    stream.userData = &counting;
+    stream.size = size;
+
+    ZELResult res;
+    ZELContext *reference = zelOpenMemory(data, size, &res);
+    assert(reference && res == ZEL_OK);
+    uint16_t out[PIXELS];
+    uint16_t expected[PIXELS];
+
+    /* An immediate preload leaves nothing for decodes to read from the stream. */
+    ZELPreloadOptions options = {ZEL_PRELOAD_ALWAYS, 0, 64, 0};
+    ZELContext *ctx = zelOpenStreamPreload(&stream, &options, &res);
+    assert(ctx && res == ZEL_OK);
+    size_t remaining = 1;
+    assert(zelPreloadStep(ctx, &remaining) == ZEL_OK && remaining == 0);
+    counting.bytesRead = 0;
+    for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+        assert(zelDecodeFrameRgb565(ctx, frame, out, W) == ZEL_OK);
+        assert(zelDecodeFrameRgb565(reference, frame, expected, W) == ZEL_OK);
+        assert(memcmp(out, expected, sizeof(out)) == 0);
+    }
+    assert(counting.bytesRead == 0);
+    zelClose(ctx);
+
+    /* Deferred: decodes work throughout, and each step reads one chunk in order. */
+    options.deferred = 1;
+    ctx = zelOpenStreamPreload(&stream, &options, &res);
+    assert(ctx && res == ZEL_OK);
+    counting.bytesRead = 0;
+    assert(zelPreloadStep(ctx, &remaining) == ZEL_OK);
+    assert(remaining == size - 64 && counting.lastReadOffset == 0 && counting.bytesRead == 64);
+    assert(zelDecodeFrameRgb565(ctx, 1, out, W) == ZEL_OK);
+    assert(zelDecodeFrameRgb565(reference, 1, expected, W) == ZEL_OK);
+    assert(memcmp(out, expected, sizeof(out)) == 0);
+    uint32_t steps = 1;
+    while (remaining > 0) {
+        assert(zelPreloadStep(ctx, &remaining) == ZEL_OK);
+        steps++;
+    }
+    assert(steps == (size + 63) / 64);
+    counting.bytesRead = 0;
+    assert(zelDecodeFrameRgb565(ctx, 2, out, W) == ZEL_OK);
+    assert(counting.bytesRead == 0);
+    zelClose(ctx);
+
+    /* The size policy streams larger files, as does the default. */
+    ZELPreloadOptions small = {ZEL_PRELOAD_BELOW_SIZE, size - 1, 0, 0};
+    ctx = zelOpenStreamPreload(&stream, &small, &res);
+    assert(ctx && res == ZEL_OK);
+    assert(zelPreloadStep(ctx, &remaining) == ZEL_OK && remaining == 0);
+    counting.bytesRead = 0;
+    assert(zelDecodeFrameRgb565(ctx, 0, out, W) == ZEL_OK);
+    assert(counting.bytesRead > 0);
+    zelClose(ctx);
+
+    small.maxBytes = size;
+    ctx = zelOpenStreamPreload(&stream, &small, &res);
+    assert(ctx && res == ZEL_OK);
+    counting.bytesRead = 0;
+    assert(zelDecodeFrameRgb565(ctx, 0, out, W) == ZEL_OK);
+    assert(counting.bytesRead == 0);
+    zelClose(ctx);
+
+    ZELPreloadOptions bad = {(ZELPreloadMode)7, 0, 0, 0};
+    assert(zelOpenStreamPreload(&stream, &bad, &res) == NULL && res == ZEL_ERR_INVALID_ARGUMENT);
+    assert(zelOpenStreamPreload(&stream, NULL, &res) == NULL && res == ZEL_ERR_INVALID_ARGUMENT);
+
+    zelClose(reference);
+    free(data);
+}
+
 static void test_timeline_helpers(void) {
     size_t size = 0;
     uint8_t *data = buildSimpleZelThreeFrames(&size);
@@ -915,6 +2892,30 @@ int main(void) {
     test_decode_rgb565();
     test_palette_endianness_controls();
     test_zone_decoders();
+    test_decode_batch_rgb565();
+    test_decode_frame_range();
+    test_validate();
+    test_trusted_mode();
+    test_palette_transform();
+    test_render_index8_with_palette();
+    test_decode_oriented();
+    test_decode_to_zones();
+    test_frame_decoder_steps();
+    test_stream_zone_reads();
+    test_frame_copy_descriptors();
+    test_alpha_palette_blend();
+    test_decode_packed_formats();
+    test_decode_gray_formats();
+    test_decode_lut_formats();
+    test_decode_positioned_clipped();
+    test_player_pacing();
+    test_compositor_layers();
+    test_scheduler_deadlines();
+    test_file_stream_adapters();
+    test_uring_prefetch();
+    test_stream_read_hints();
+    test_stream_vectored_reads();
+    test_stream_preload();
     test_timeline_helpers();
     test_invalid_headers_and_sizes();
     test_corrupt_zone_chunks();